@@ -0,0 +1,511 @@
+/*
+ * bench.orange.cc
+ *
+ * Google Benchmark suite for orange pipelines. Each pipeline is paired
+ * with the loop we'd write by hand, over the same source, so the two
+ * are next to each other in the output:
+ *
+ *      make bench
+ *
+ * Sources:    ints(n), a vector, a C array (1K and 1M only) and an
+ *             'owning_range' (via an rvalue that just borrows a vector's
+ *             memory, so nothing is copied per iteration).
+ * Sizes:      1K, 1M and 100M elements.
+ *
+ * Counters:   'time/elem' is the time per element, and 'allocs' is the
+ *             number of calls to 'operator new' per iteration.
+ */
+#include "orange.hh"
+#include <benchmark/benchmark.h>
+
+#include<atomic>
+#include<cstdlib>
+#include<new>
+#include<vector>
+
+using namespace orange;
+
+/*
+ * Count every allocation, so we can see that pipelines don't allocate
+ * (other than '|collect', which should allocate once).
+ */
+static std:: atomic<size_t> g_allocations {0};
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"  // our 'delete' matches our 'new', but g++ can't see that
+#endif
+
+void * operator new(size_t n) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if(void * p = std::malloc(n ? n : 1))
+        return p;
+    throw std:: bad_alloc();
+}
+void * operator new[](size_t n)             { return ::operator new(n); }
+void operator delete(void * p) noexcept     { std::free(p); }
+void operator delete[](void * p) noexcept   { std::free(p); }
+void operator delete(void * p, size_t) noexcept     { std::free(p); }
+void operator delete[](void * p, size_t) noexcept   { std::free(p); }
+
+namespace {
+
+    constexpr int64_t size_1K   = 1000;
+    constexpr int64_t size_1M   = 1000000;
+    constexpr int64_t size_100M = 100000000;
+
+    // One vector at a time, reused by every benchmark of the same size
+    std:: vector<int> &
+    data_of_size(size_t n) {
+        static std:: vector<int> v;
+        if(v.size() != n) {
+            v.clear();
+            v.shrink_to_fit();
+            v.resize(n);
+            for(size_t i = 0; i<n; ++i)
+                v[i] = static_cast<int>(i % 1000);
+        }
+        return v;
+    }
+    std:: vector<int> &
+    second_data_of_size(size_t n) {
+        static std:: vector<int> v;
+        if(v.size() != n)
+            v.assign(n, 3);
+        return v;
+    }
+    // somewhere for '|copy_to|' to write
+    std:: vector<int64_t> &
+    output_of_size(size_t n) {
+        static std:: vector<int64_t> v;
+        if(v.size() != n)
+            v.assign(n, 0);
+        return v;
+    }
+
+    int array_1K[size_1K];
+    int array_1M[size_1M];
+
+    // a container that borrows memory, so 'as_range' of an rvalue gives
+    // an 'owning_range' without copying anything
+    struct borrowed_span {
+        int * m_b;
+        int * m_e;
+        int * begin() const { return m_b; }
+        int * end()   const { return m_e; }
+    };
+
+    // The sources. 'prepare' fills in the data, once per benchmark, and
+    // 'make' gives a fresh range over it, cheaply, for each iteration
+    struct ints_source {
+        static void prepare(size_t)             {}
+        static auto make(size_t n)              { return ints(static_cast<int>(n)); }
+    };
+    struct vector_source {
+        static void prepare(size_t n)           { data_of_size(n); }
+        static auto make(size_t n)              { return as_range(data_of_size(n)); }
+    };
+    struct array_source { // only for 1K and 1M
+        template<size_t N>
+        static void fill(int (&a)[N])           { for(size_t i = 0; i<N; ++i) a[i] = static_cast<int>(i % 1000); }
+        static void prepare(size_t n)           { if(n == size_1K) fill(array_1K); else fill(array_1M); }
+        static auto make(size_t n)              { return n == size_1K ? as_range(array_1K) : as_range(array_1M); }
+    };
+    struct owning_source {
+        static void prepare(size_t n)           { data_of_size(n); }
+        static auto make(size_t n)              { auto & v = data_of_size(n); return as_range(borrowed_span{v.data(), v.data() + n}); }
+    };
+
+    struct square_t { int64_t operator() (int x) const { return int64_t(x) * x; } };
+    struct is_odd_t { bool    operator() (int x) const { return x % 2 != 0; } };
+    struct is_negative_t { bool operator() (int x) const { return x < 0; } };
+    struct plus_t   { int64_t operator() (int x, int y) const { return int64_t(x) + y; } };
+
+    // time per element, and allocations per iteration
+    void
+    report(benchmark::State & state, size_t n, size_t allocations_before) {
+        // read before inserting into 'counters', which may allocate
+        size_t allocations = g_allocations - allocations_before;
+        state.counters["time/elem"] = benchmark::Counter( static_cast<double>(n)
+                                    , benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+        state.counters["allocs"]    = benchmark::Counter( static_cast<double>(allocations)
+                                    , benchmark::Counter::kAvgIterations);
+    }
+}
+
+
+/*  |accumulate  */
+template<typename Source>
+void BM_accumulate(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    Source::prepare(n);
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        benchmark::DoNotOptimize( Source::make(n) |accumulate );
+    }
+    report(state, n, allocs);
+}
+
+/*  |mapr| ... |accumulate  */
+template<typename Source>
+void BM_mapr_accumulate(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    Source::prepare(n);
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        benchmark::DoNotOptimize( Source::make(n) |mapr| square_t{} |accumulate );
+    }
+    report(state, n, allocs);
+}
+
+/*  |filter| ... |accumulate  */
+template<typename Source>
+void BM_filter_accumulate(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    Source::prepare(n);
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        benchmark::DoNotOptimize( Source::make(n) |filter| is_odd_t{} |accumulate );
+    }
+    report(state, n, allocs);
+}
+
+/*  for(auto x : r |filter| ... |mapr| ...), against the same with |foreach|  */
+template<typename Source>
+void BM_filter_mapr_range_for(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    Source::prepare(n);
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        int64_t total = 0;
+        for(int64_t x : Source::make(n) |filter| is_odd_t{} |mapr| square_t{})
+            total += x;
+        benchmark::DoNotOptimize( total );
+    }
+    report(state, n, allocs);
+}
+template<typename Source>
+void BM_filter_mapr_foreach(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    Source::prepare(n);
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        int64_t total = 0;
+        Source::make(n) |filter| is_odd_t{} |mapr| square_t{} |foreach| [&](int64_t x){ total += x; };
+        benchmark::DoNotOptimize( total );
+    }
+    report(state, n, allocs);
+}
+
+/*  |mapr| ... |collect  */
+template<typename Source>
+void BM_mapr_collect(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    Source::prepare(n);
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        auto v = Source::make(n) |mapr| square_t{} |collect;
+        benchmark::DoNotOptimize( v.data() );
+    }
+    report(state, n, allocs);
+}
+
+/*  |copy_to| a vector that's already the right size, and |mapr| ... |copy_to|  */
+template<typename Source>
+void BM_copy_to(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    Source::prepare(n);
+    std:: vector<int> out(n);
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        size_t copied = Source::make(n) |copy_to| out;
+        benchmark::DoNotOptimize(copied);
+        benchmark::ClobberMemory();
+    }
+    report(state, n, allocs);
+}
+template<typename Source>
+void BM_mapr_copy_to(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    Source::prepare(n);
+    auto & out = output_of_size(n);
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        size_t copied = Source::make(n) |mapr| square_t{} |copy_to| out;
+        benchmark::DoNotOptimize(copied);
+        benchmark::ClobberMemory();
+    }
+    report(state, n, allocs);
+}
+
+/*  |find_if| with no match, so it reads everything, and |min_max  */
+template<typename Source>
+void BM_find_if(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    Source::prepare(n);
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        auto found = Source::make(n) |find_if| is_negative_t{};
+        benchmark::DoNotOptimize( found.has_value() );
+    }
+    report(state, n, allocs);
+}
+template<typename Source>
+void BM_min_max(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    Source::prepare(n);
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        auto mm = *(Source::make(n) |min_max);
+        benchmark::DoNotOptimize( mm.m_min );
+        benchmark::DoNotOptimize( mm.m_max );
+    }
+    report(state, n, allocs);
+}
+
+/*  |mapr| ... |memoize |accumulate  */
+template<typename Source>
+void BM_memoize_accumulate(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    Source::prepare(n);
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        benchmark::DoNotOptimize( Source::make(n) |mapr| square_t{} |memoize |accumulate );
+    }
+    report(state, n, allocs);
+}
+
+/*  zip(r, v) |mapr| apply_pack % plus |accumulate  */
+template<typename Source>
+void BM_zip_accumulate(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    Source::prepare(n);
+    auto & w = second_data_of_size(n);
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        benchmark::DoNotOptimize( zip(Source::make(n), w) |mapr| apply_pack % plus_t{} |accumulate );
+    }
+    report(state, n, allocs);
+}
+
+template<typename Source>
+void BM_zip_as_is_accumulate(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    Source::prepare(n);
+    auto & w = second_data_of_size(n);
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        benchmark::DoNotOptimize( zip_as_is(Source::make(n), w) |mapr| apply_pack % plus_t{} |accumulate );
+    }
+    report(state, n, allocs);
+}
+
+/*  |concat, over a vector of vectors of 1000 each. '|memoize' keeps each inner range in place  */
+void BM_concat_accumulate(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    std:: vector<std::vector<int>> vv(n / 1000, std::vector<int>(1000, 1));
+    size_t allocs = g_allocations;
+    for(auto _ : state)
+        benchmark::DoNotOptimize( vv |mapr| [](std::vector<int> & v){ return as_range(v); } |memoize |concat |accumulate );
+    report(state, n, allocs);
+}
+
+void BM_concat_accumulate_by_hand(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    std:: vector<std::vector<int>> vv(n / 1000, std::vector<int>(1000, 1));
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        int64_t total = 0;
+        for(auto & v : vv)
+            for(int x : v)
+                total += x;
+        benchmark::DoNotOptimize(total);
+    }
+    report(state, n, allocs);
+}
+
+
+/*
+ * The loops we'd write by hand. Over memory (a vector, a C array or an
+ * owning_range all look like this) and over a counter, for 'ints(n)'.
+ */
+
+void BM_accumulate_by_hand_ints(benchmark::State & state) {
+    int n = static_cast<int>(state.range(0));
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        int64_t total = 0;
+        for(int i = 0; i<n; ++i)
+            total += i;
+        benchmark::DoNotOptimize(total);
+    }
+    report(state, static_cast<size_t>(n), allocs);
+}
+void BM_mapr_accumulate_by_hand_ints(benchmark::State & state) {
+    int n = static_cast<int>(state.range(0));
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        int64_t total = 0;
+        for(int i = 0; i<n; ++i)
+            total += int64_t(i) * i;
+        benchmark::DoNotOptimize(total);
+    }
+    report(state, static_cast<size_t>(n), allocs);
+}
+void BM_filter_accumulate_by_hand_ints(benchmark::State & state) {
+    int n = static_cast<int>(state.range(0));
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        int64_t total = 0;
+        for(int i = 0; i<n; ++i)
+            if(i % 2 != 0)
+                total += i;
+        benchmark::DoNotOptimize(total);
+    }
+    report(state, static_cast<size_t>(n), allocs);
+}
+
+void BM_accumulate_by_hand(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    int const * p = data_of_size(n).data();
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        int64_t total = 0;
+        for(size_t i = 0; i<n; ++i)
+            total += p[i];
+        benchmark::DoNotOptimize(total);
+    }
+    report(state, n, allocs);
+}
+void BM_mapr_accumulate_by_hand(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    int const * p = data_of_size(n).data();
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        int64_t total = 0;
+        for(size_t i = 0; i<n; ++i)
+            total += int64_t(p[i]) * p[i];
+        benchmark::DoNotOptimize(total);
+    }
+    report(state, n, allocs);
+}
+void BM_filter_accumulate_by_hand(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    int const * p = data_of_size(n).data();
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        int64_t total = 0;
+        for(size_t i = 0; i<n; ++i)
+            if(p[i] % 2 != 0)
+                total += p[i];
+        benchmark::DoNotOptimize(total);
+    }
+    report(state, n, allocs);
+}
+void BM_mapr_collect_by_hand(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    int const * p = data_of_size(n).data();
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        std:: vector<int64_t> v;
+        v.reserve(n);
+        for(size_t i = 0; i<n; ++i)
+            v.push_back(int64_t(p[i]) * p[i]);
+        benchmark::DoNotOptimize( v.data() );
+    }
+    report(state, n, allocs);
+}
+void BM_mapr_copy_to_by_hand(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    int const * p = data_of_size(n).data();
+    int64_t * out = output_of_size(n).data();
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        for(size_t i = 0; i<n; ++i)
+            out[i] = int64_t(p[i]) * p[i];
+        benchmark::ClobberMemory();
+    }
+    report(state, n, allocs);
+}
+void BM_find_if_by_hand(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    int const * p = data_of_size(n).data();
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        size_t i = 0;
+        while(i<n && !(p[i] < 0))
+            ++i;
+        benchmark::DoNotOptimize(i);
+    }
+    report(state, n, allocs);
+}
+void BM_zip_accumulate_by_hand(benchmark::State & state) {
+    size_t n = static_cast<size_t>(state.range(0));
+    int const * p = data_of_size(n).data();
+    int const * q = second_data_of_size(n).data();
+    size_t allocs = g_allocations;
+    for(auto _ : state) {
+        int64_t total = 0;
+        for(size_t i = 0; i<n; ++i)
+            total += int64_t(p[i]) + q[i];
+        benchmark::DoNotOptimize(total);
+    }
+    report(state, n, allocs);
+}
+
+#define ORANGE_BENCH_ALL_SIZES(...)     BENCHMARK(__VA_ARGS__)->Arg(size_1K)->Arg(size_1M)->Arg(size_100M)->Unit(benchmark::kMicrosecond)
+#define ORANGE_BENCH_SMALL_SIZES(...)   BENCHMARK(__VA_ARGS__)->Arg(size_1K)->Arg(size_1M)                ->Unit(benchmark::kMicrosecond)
+
+ORANGE_BENCH_ALL_SIZES  (BM_accumulate<ints_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_accumulate_by_hand_ints);
+ORANGE_BENCH_ALL_SIZES  (BM_accumulate<vector_source>);
+ORANGE_BENCH_SMALL_SIZES(BM_accumulate<array_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_accumulate<owning_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_accumulate_by_hand);
+
+ORANGE_BENCH_ALL_SIZES  (BM_mapr_accumulate<ints_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_mapr_accumulate_by_hand_ints);
+ORANGE_BENCH_ALL_SIZES  (BM_mapr_accumulate<vector_source>);
+ORANGE_BENCH_SMALL_SIZES(BM_mapr_accumulate<array_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_mapr_accumulate<owning_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_mapr_accumulate_by_hand);
+
+ORANGE_BENCH_ALL_SIZES  (BM_filter_accumulate<ints_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_filter_accumulate_by_hand_ints);
+ORANGE_BENCH_ALL_SIZES  (BM_filter_accumulate<vector_source>);
+ORANGE_BENCH_SMALL_SIZES(BM_filter_accumulate<array_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_filter_accumulate<owning_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_filter_accumulate_by_hand);
+
+ORANGE_BENCH_ALL_SIZES  (BM_filter_mapr_range_for<ints_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_filter_mapr_foreach<ints_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_filter_mapr_range_for<vector_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_filter_mapr_foreach<vector_source>);
+
+ORANGE_BENCH_ALL_SIZES  (BM_mapr_collect<ints_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_mapr_collect<vector_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_mapr_collect<owning_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_mapr_collect_by_hand);
+
+ORANGE_BENCH_ALL_SIZES  (BM_copy_to<vector_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_copy_to<ints_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_mapr_copy_to<vector_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_mapr_copy_to_by_hand);
+
+ORANGE_BENCH_ALL_SIZES  (BM_find_if<vector_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_find_if<ints_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_find_if_by_hand);
+ORANGE_BENCH_ALL_SIZES  (BM_min_max<vector_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_min_max<ints_source>);
+
+ORANGE_BENCH_ALL_SIZES  (BM_memoize_accumulate<ints_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_memoize_accumulate<vector_source>);
+
+ORANGE_BENCH_ALL_SIZES  (BM_zip_accumulate<vector_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_zip_as_is_accumulate<vector_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_zip_accumulate<ints_source>);
+ORANGE_BENCH_ALL_SIZES  (BM_zip_accumulate_by_hand);
+
+ORANGE_BENCH_ALL_SIZES  (BM_concat_accumulate);
+ORANGE_BENCH_ALL_SIZES  (BM_concat_accumulate_by_hand);
+
+BENCHMARK_MAIN();
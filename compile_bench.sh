@@ -0,0 +1,70 @@
+#!/bin/bash
+#
+# compile_bench.sh - how the cost of compiling a pipeline grows with its length
+#
+#   ./compile_bench.sh [stages ...]         (default: 1 5 10 20)
+#
+# For each N, this generates a translation unit with one N-stage pipeline,
+# alternating '|mapr|' and '|filter|' with a distinct function type in every
+# stage, so that no stage can reuse the instantiations of a previous one.
+# It then reports the time taken by '-fsyntax-only' and, with g++, how many
+# classes were instantiated, as listed by '-fdump-lang-class'.
+#
+# 'CXX' and 'CXXFLAGS' are taken from the environment, as with 'make'.
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++14}
+HERE=$(cd "$(dirname "$0")" && pwd)
+
+[ $# -eq 0 ] && set -- 1 5 10 20
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+generate() {
+    local n=$1
+    echo '#include "orange.hh"'
+    echo 'using namespace orange;'
+    for ((i = 0; i < n; i++)); do
+        if ((i % 2 == 0)); then
+            echo "struct stage$i { template<typename T> constexpr auto operator()(T x) const { return x + $i; } };"
+        else
+            echo "struct stage$i { template<typename T> constexpr bool operator()(T x) const { return x % $((i + 1)) != 0; } };"
+        fi
+    done
+    echo 'int main() {'
+    echo '    return ints(1000)'
+    for ((i = 0; i < n; i++)); do
+        if ((i % 2 == 0)); then
+            echo "        |mapr|    stage$i{}"
+        else
+            echo "        |filter|  stage$i{}"
+        fi
+    done
+    echo '        |accumulate;'
+    echo '}'
+}
+
+dump_classes=
+case "$("$CXX" --version 2>/dev/null | head -n 1)" in
+    *clang*)    ;;
+    *)          dump_classes=-fdump-lang-class ;;
+esac
+
+printf '%8s %10s %16s %14s\n' stages seconds orange-classes all-classes
+for n in "$@"; do
+    tu="$WORK/pipeline_$n.cc"
+    generate "$n" > "$tu"
+    start=$(date +%s.%N)
+    ( cd "$WORK" && "$CXX" $CXXFLAGS -I"$HERE" -fsyntax-only $dump_classes "pipeline_$n.cc" ) || exit 1
+    end=$(date +%s.%N)
+    orange_classes=-
+    all_classes=-
+    if [ -n "$dump_classes" ]; then
+        dump=$(ls "$WORK"/*.class)
+        orange_classes=$(grep -c '^Class orange::' "$dump")
+        all_classes=$(grep -c '^Class ' "$dump")
+        rm -f "$dump"
+    fi
+    printf '%8d %10.2f %16s %14s\n' "$n" "$(awk "BEGIN { print $end - $start }")" "$orange_classes" "$all_classes"
+done
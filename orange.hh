@@ -62,6 +62,26 @@
  *  -   pull        ::: return the current value and also advance. As if
  *                      running front_val and then advance. Useful when a
  *                      range doesn't allow repeating read
+ *  -   pull_n      ::: pull up to 'n' values into an array, returning how
+ *                      many were written. Fewer than 'n' means the range is
+ *                      now empty. Simple ranges fill a whole block at once,
+ *                      so this saves one 'empty' and 'advance' per item.
+ *  -   slice       ::: slice(r,b,e) is a new range over positions [b,e) of
+ *                      'r', where 'slice_length' gives the number of positions.
+ *                      For most ranges there is one position per item, so
+ *                      'slice_length' is just 'size'.  But a '|filter|' has
+ *                      the positions of its underlying range, and drops some
+ *                      of them. This is what the parallel modes use to split
+ *                      a range into pieces that can run independently.
+ *  -   size        ::: the exact number of items remaining. Only for ranges
+ *                      that can know this cheaply.
+ *  -   size_hint   ::: what we know about the number of items remaining;
+ *                      it may be exact, a lower bound, an upper bound, or
+ *                      unknown. Synthesized from 'size' where possible, and
+ *                      used by '|collect' to reserve memory up front.
+ *  -   data        ::: a pointer to the remaining items, if they are stored
+ *                      contiguously (with 'size' of them). This allows
+ *                      '|accumulate' to use several accumulators at once.
  *
  * Via traits (see below), you can specify, for your own types, how these
  * actions are to be performed on your objects.
@@ -98,9 +118,8 @@
  *  template<typename I>
  *  struct traits<std:: pair<I,I>>
  *
- * For now, this just means providing 'empty', 'advance' and 'front_val'
- * In future, some functions for trait a pair as an output range should
- * be added, such as 'full' and 'front_ref'.
+ * This means providing 'empty', 'advance' and 'front_val', and also 'full'
+ * and 'push' so that a pair can be written to as an output range.
  *
  * Next, the functions in 'orange::' are defined, relying on the operations
  * provided in the traits object. For example, this defines 'orange::front_val':
@@ -115,13 +134,24 @@
  *
  */
 
+#ifndef AMD_ORANGE_HH
+#define AMD_ORANGE_HH
+
 #include<utility>
 #include<functional>
 #include<algorithm> // for std::min
 #include<tuple>
 #include<vector>
+#include<array>
 #include<limits>
+#include<cstddef> // for 'std::max_align_t'
+#include<cstdint> // for 'uintptr_t'
+#include<string> // only for 'is_contiguous_iterator_v'
+#include<stdexcept> // for 'std::length_error', in '|collect_static'
 #include<memory>
+#include<new> // for placement new, in 'optional_value'
+#include<cassert> // only for debug checks in range-based for
+#include<iosfwd> // for 'std::streamsize', in 'ostream_sink'
 
  /* SFINAE_ENABLE_IF_CHECK
   * ======================
@@ -204,8 +234,18 @@ namespace orange_utils {
      *  ==============
      *  is_invokable_v<F, Args...> tells us if the function object F
      *  can be called with arguments of types Args...
+     *
+     *  This is behind every 'has_trait_*' and so it's instantiated many times
+     *  for every stage of a pipeline. A partial specialization is cheaper to
+     *  compile than overload resolution, and a 'requires' expression (in C++20)
+     *  is cheaper again.
      */
     namespace impl__is_invokable {
+#if defined(__cpp_concepts) && __cpp_concepts >= 201907L
+        template<typename F, typename ... Args>
+        constexpr bool
+        is_invokable_v = requires { std::declval<F>()(std::declval<Args>()...); };
+#else
         template<typename F, typename ... Args>
         constexpr auto
         is_invokable_one_overload(orange_utils::priority_tag<2>)
@@ -222,6 +262,7 @@ namespace orange_utils {
         constexpr bool
         is_invokable_v =
                    is_invokable_one_overload<F, Args...>(orange_utils::priority_tag<9>{});
+#endif
     }
 
     using impl__is_invokable:: is_invokable_v;  // to 'export' this to the orange_utils namespace
@@ -280,6 +321,105 @@ namespace orange_utils {
     auto non_rref(T&& t)
     -> typename remove_RVALUE_reference<T>::type
     { return t; }
+
+    /*  optional_value
+     *  ==============
+     *      Room for zero or one 'T', stored inline. Just enough of
+     *  'std::optional' for our needs, as we can't assume C++17.
+     *
+     *      If 'T' is trivially copyable and destructible, then so is
+     *  'optional_value<T>', and it can be used in constexpr functions.
+     *  (It must also be assignable, as that's how 'emplace' works then.
+     *  A trivially-copyable lambda isn't, for example.)
+     */
+    struct optional_value_in_place_t { constexpr optional_value_in_place_t() {} };
+
+    template<typename T
+            , bool trivial =     std::is_trivially_copyable<T>{} && std::is_trivially_destructible<T>{}
+                            &&   std::is_copy_assignable<T>{} >
+    struct optional_value;
+
+    template<typename T>
+    struct optional_value<T, true>
+    {
+        union { char m_nothing; T m_value; };
+        bool m_engaged;
+
+        constexpr optional_value() : m_nothing(), m_engaged(false) {}
+
+        template<typename ... Args>
+        constexpr explicit
+        optional_value(optional_value_in_place_t, Args && ... args)
+        : m_value(std::forward<Args>(args)...), m_engaged(true) {}
+
+        constexpr bool      has_value()     const   { return m_engaged; }
+        constexpr T &       operator*()             { return m_value; }
+        constexpr T const & operator*()     const   { return m_value; }
+
+        constexpr void      reset()                 { *this = optional_value{}; }
+
+        // assigning a whole new 'optional_value' is the constexpr way to change the active member
+        template<typename ... Args>
+        constexpr T &
+        emplace(Args && ... args) {
+            *this = optional_value{ optional_value_in_place_t{}, std::forward<Args>(args)... };
+            return m_value;
+        }
+    };
+
+    template<typename T>
+    struct optional_value<T, false>
+    {
+        union { char m_nothing; T m_value; };
+        bool m_engaged;
+
+        optional_value() : m_nothing(), m_engaged(false) {}
+
+        optional_value(optional_value const & other) : optional_value()
+        { if(other.m_engaged) emplace(other.m_value); }
+        optional_value(optional_value && other) : optional_value()
+        { if(other.m_engaged) emplace(std::move(other.m_value)); }
+
+        optional_value &
+        operator= (optional_value const & other) {
+            if(this != &other) {
+                reset();
+                if(other.m_engaged) emplace(other.m_value);
+            }
+            return *this;
+        }
+        optional_value &
+        operator= (optional_value && other) {
+            if(this != &other) {
+                reset();
+                if(other.m_engaged) emplace(std::move(other.m_value));
+            }
+            return *this;
+        }
+
+        ~optional_value() { reset(); }
+
+        bool        has_value()     const   { return m_engaged; }
+        T &         operator*()             { return m_value; }
+        T const &   operator*()     const   { return m_value; }
+
+        void
+        reset() {
+            if(m_engaged) {
+                m_value.~T();
+                m_engaged = false;
+            }
+        }
+
+        template<typename ... Args>
+        T &
+        emplace(Args && ... args) {
+            reset();
+            ::new (static_cast<void*>(&m_value)) T(std::forward<Args>(args)...);
+            m_engaged = true;
+            return m_value;
+        }
+    };
 }
 
 namespace orange {
@@ -301,11 +441,11 @@ namespace orange {
      *  ================
      *      We don't look up 'traits' directly. We go through 'lookup_traits'
      *  instead, as it drops 'const' and drops references.
+     *      It's an alias, not a class, so that 'R', 'R&' and 'R const &' all
+     *  share the one instantiation of 'traits<R>'.
      */
-    template<typename R
-            , typename R_decayed = std::decay_t<R>
-            , decltype( traits< R_decayed> {} ) * = nullptr >
-    struct lookup_traits : public traits<R_decayed> {};
+    template<typename R>
+    using lookup_traits = traits<std::decay_t<R>>;
 
 
     /*  checker_for__is_range  is_range_v
@@ -319,17 +459,67 @@ namespace orange {
     is_range_v = orange_utils:: is_invokable_v<decltype(checker_for__is_range), T>;
 
 
-    /*  has_trait_{empty,advance,front,pull}
-     *  ==================================================
+    /*  has_trait_{empty,advance,front,pull,pull_n,size,size_hint,slice,slice_length,data,front_mapped,advance_n,front_at,begin,full,push}
+     *  =======================================================================================================
      *      In order to 'synthesize' the user-facing functions ( orange::front, orange::empty, and so on )
      *  for a range type R, we need a convenient way to check which functions are provided in the trait<R>.
      *  These are the 'has_trait_*' functions defined here:
      */
 
+#if defined(__cpp_concepts) && __cpp_concepts >= 201907L
+    /*  With C++20, each of these is one 'requires' expression. This is the same test
+     *  as the 'checker_for__' lambdas below, but without instantiating a lambda for
+     *  every range type at every stage of every pipeline.
+     */
+    template<typename R> constexpr bool
+    has_trait_empty     = requires(R&& r) { lookup_traits<R>::empty    (r); };
+    template<typename R> constexpr bool
+    has_trait_advance   = requires(R&& r) { lookup_traits<R>::advance  (r); };
+    template<typename R> constexpr bool
+    has_trait_front     = requires(R&& r) { lookup_traits<R>::front    (r); };
+    template<typename R> constexpr bool
+    has_trait_pull      = requires(R&& r) { lookup_traits<R>::pull     (r); };
+    template<typename R, typename T> constexpr bool // can this range write its values into a 'T*' ?
+    has_trait_pull_n    = requires(R&& r, T* out) { lookup_traits<R>::pull_n   (r, out, size_t(0)); };
+    template<typename R> constexpr bool
+    has_trait_size      = requires(R&& r) { lookup_traits<R>::size     (r); };
+    template<typename R> constexpr bool
+    has_trait_size_hint = requires(R&& r) { lookup_traits<R>::size_hint(r); };
+    template<typename R> constexpr bool
+    has_trait_slice     = requires(R&& r) { lookup_traits<R>::slice    (r, size_t(0), size_t(0)); };
+    template<typename R> constexpr bool
+    has_trait_slice_length = requires(R&& r) { lookup_traits<R>::slice_length(r); };
+    template<typename R> constexpr bool
+    has_trait_data      = requires(R&& r) { lookup_traits<R>::data     (r); };
+    template<typename R, typename F> constexpr bool // can this range call 'F' on its front more directly?
+    has_trait_front_mapped = requires(R&& r, F&& f) { lookup_traits<R>::front_mapped(r, f); };
+    template<typename R> constexpr bool
+    has_trait_advance_n = requires(R&& r) { lookup_traits<R>::advance_n(r, size_t(0)); };
+    template<typename R> constexpr bool
+    has_trait_front_at  = requires(R&& r) { lookup_traits<R>::front_at (r, size_t(0)); };
+    template<typename R> constexpr bool
+    has_trait_begin     = requires(R&& r) { lookup_traits<R>::begin    (r); };
+    template<typename R> constexpr bool
+    has_trait_full      = requires(R&& r) { lookup_traits<R>::full     (r); };
+    template<typename R, typename T> constexpr bool // can a 'T' be written to this output range?
+    has_trait_push      = requires(R&& r, T&& t) { lookup_traits<R>::push     (r, std::forward<T>(t)); };
+#else
     auto checker_for__has_trait_empty       = [](auto&&r)->decltype(void( lookup_traits<decltype(r)>::empty    (r) )){};
     auto checker_for__has_trait_advance     = [](auto&&r)->decltype(void( lookup_traits<decltype(r)>::advance  (r) )){};
     auto checker_for__has_trait_front       = [](auto&&r)->decltype(void( lookup_traits<decltype(r)>::front    (r) )){};
     auto checker_for__has_trait_pull        = [](auto&&r)->decltype(void( lookup_traits<decltype(r)>::pull     (r) )){};
+    auto checker_for__has_trait_pull_n      = [](auto&&r, auto out)->decltype(void( lookup_traits<decltype(r)>::pull_n   (r, out, size_t(0)) )){};
+    auto checker_for__has_trait_size        = [](auto&&r)->decltype(void( lookup_traits<decltype(r)>::size     (r) )){};
+    auto checker_for__has_trait_size_hint   = [](auto&&r)->decltype(void( lookup_traits<decltype(r)>::size_hint(r) )){};
+    auto checker_for__has_trait_slice       = [](auto&&r)->decltype(void( lookup_traits<decltype(r)>::slice    (r, size_t(0), size_t(0)) )){};
+    auto checker_for__has_trait_slice_length= [](auto&&r)->decltype(void( lookup_traits<decltype(r)>::slice_length(r) )){};
+    auto checker_for__has_trait_data        = [](auto&&r)->decltype(void( lookup_traits<decltype(r)>::data     (r) )){};
+    auto checker_for__has_trait_front_mapped= [](auto&&r, auto&&f)->decltype(void( lookup_traits<decltype(r)>::front_mapped(r, f) )){};
+    auto checker_for__has_trait_advance_n   = [](auto&&r)->decltype(void( lookup_traits<decltype(r)>::advance_n(r, size_t(0)) )){};
+    auto checker_for__has_trait_front_at    = [](auto&&r)->decltype(void( lookup_traits<decltype(r)>::front_at (r, size_t(0)) )){};
+    auto checker_for__has_trait_begin       = [](auto&&r)->decltype(void( lookup_traits<decltype(r)>::begin    (r) )){};
+    auto checker_for__has_trait_full        = [](auto&&r)->decltype(void( lookup_traits<decltype(r)>::full     (r) )){};
+    auto checker_for__has_trait_push        = [](auto&&r, auto&&t)->decltype(void( lookup_traits<decltype(r)>::push     (r, std::forward<decltype(t)>(t)) )){};
 
     template<typename R> constexpr bool
     has_trait_empty     = orange_utils:: is_invokable_v<decltype(checker_for__has_trait_empty), R>;
@@ -339,6 +529,31 @@ namespace orange {
     has_trait_front     = orange_utils:: is_invokable_v<decltype(checker_for__has_trait_front    ), R>;
     template<typename R> constexpr bool
     has_trait_pull      = orange_utils:: is_invokable_v<decltype(checker_for__has_trait_pull), R>;
+    template<typename R, typename T> constexpr bool // can this range write its values into a 'T*' ?
+    has_trait_pull_n    = orange_utils:: is_invokable_v<decltype(checker_for__has_trait_pull_n), R, T*>;
+    template<typename R> constexpr bool
+    has_trait_size      = orange_utils:: is_invokable_v<decltype(checker_for__has_trait_size), R>;
+    template<typename R> constexpr bool
+    has_trait_size_hint = orange_utils:: is_invokable_v<decltype(checker_for__has_trait_size_hint), R>;
+    template<typename R> constexpr bool
+    has_trait_slice     = orange_utils:: is_invokable_v<decltype(checker_for__has_trait_slice), R>;
+    template<typename R> constexpr bool
+    has_trait_slice_length = orange_utils:: is_invokable_v<decltype(checker_for__has_trait_slice_length), R>;
+    template<typename R> constexpr bool
+    has_trait_data      = orange_utils:: is_invokable_v<decltype(checker_for__has_trait_data), R>;
+    template<typename R, typename F> constexpr bool // can this range call 'F' on its front more directly?
+    has_trait_front_mapped = orange_utils:: is_invokable_v<decltype(checker_for__has_trait_front_mapped), R, F>;
+    template<typename R> constexpr bool
+    has_trait_advance_n = orange_utils:: is_invokable_v<decltype(checker_for__has_trait_advance_n), R>;
+    template<typename R> constexpr bool
+    has_trait_front_at  = orange_utils:: is_invokable_v<decltype(checker_for__has_trait_front_at), R>;
+    template<typename R> constexpr bool
+    has_trait_begin     = orange_utils:: is_invokable_v<decltype(checker_for__has_trait_begin), R>;
+    template<typename R> constexpr bool
+    has_trait_full      = orange_utils:: is_invokable_v<decltype(checker_for__has_trait_full), R>;
+    template<typename R, typename T> constexpr bool // can a 'T' be written to this output range?
+    has_trait_push      = orange_utils:: is_invokable_v<decltype(checker_for__has_trait_push), R, T>;
+#endif
 
 
     /*
@@ -378,28 +593,99 @@ namespace orange {
     ->decltype(lookup_traits<R>::front(r))
     {   return lookup_traits<R>::front(r); }
 
+
+    /*  'full' and 'push', for output ranges
+     *      'push(r, x)' writes 'x' and moves on to the next position, while
+     *  'full(r)' is true once nothing more can be written. Both are taken
+     *  from the trait only.
+     */
+    template<typename R>
+    auto constexpr
+    full     (R       &r)
+    ->decltype(lookup_traits<R>::full(r))
+    {   return lookup_traits<R>::full(r); }
+
+    template<typename R, typename T>
+    auto constexpr
+    push     (R       &r, T && t)
+    ->decltype(lookup_traits<R>::push(r, std::forward<T>(t)))
+    {   return lookup_traits<R>::push(r, std::forward<T>(t)); }
+
     /* Next, we see 'begin' and 'end', which are useful
      * for working with range-based for.
      *
-     * TODO: synthesize a suitable pair of iterators
-     * for range types that don't specify a begin and
-     * end of their own.
+     * Two overloads of each
+     *  1. has 'begin' (and 'end') in its trait
+     *  2. doesn't, so we synthesize them from 'empty', 'front' and 'advance'
      */
 
-    // one overload for 'begin'
-    template<typename R>
+    namespace impl {
+        /*  range_for_iterator<R>  range_for_sentinel
+         *      The synthesized 'begin' and 'end'. The 'end' is an empty type,
+         *  so that '!=' is just '!empty(r)', and a range-based for is the same
+         *  loop as '|foreach|'. There are no checks except for the asserts.
+         *      Before C++17, range-based for needs 'begin' and 'end' to be of
+         *  the same type. Then, 'end' is a 'range_for_iterator' with a null
+         *  pointer instead.
+         */
+        struct range_for_sentinel { constexpr range_for_sentinel() {} };
+
+        template<typename R>
+        struct range_for_iterator {
+            R * m_r;
+
+            constexpr bool
+            operator!= (range_for_sentinel)                 const { return !orange::empty(*m_r); }
+            constexpr bool
+            operator== (range_for_sentinel)                 const { return  orange::empty(*m_r); }
+            // only for comparing to the 'end' before C++17
+            constexpr bool
+            operator!= (range_for_iterator const & end)     const { assert(end.m_r == nullptr); (void)end; return !orange::empty(*m_r); }
+
+            constexpr range_for_iterator &
+            operator++ ()           { assert(!orange::empty(*m_r)); orange::advance(*m_r); return *this; }
+            constexpr decltype(auto)
+            operator*  ()   const   { assert(!orange::empty(*m_r)); return orange::front(*m_r); }
+        };
+    }
+
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( has_trait_begin<R&> )
+            >
     auto constexpr
     begin      (R       &r)
     ->decltype(lookup_traits<R>::begin  (r))
     {   return lookup_traits<R>::begin  (r); }
 
-    // one overload for 'end'
-    template<typename R>
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( has_trait_begin<R&> )
+            >
     auto constexpr
     end        (R       &r)
     ->decltype(lookup_traits<R>::end    (r))
     {   return lookup_traits<R>::end    (r); }
 
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( !has_trait_begin<R&> && has_trait_empty<R&> && has_trait_front<R&> && has_trait_advance<R&> )
+            >
+    auto constexpr
+    begin      (R       &r)
+    -> impl:: range_for_iterator<R>
+    {   return { &r }; }
+
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( !has_trait_begin<R&> && has_trait_empty<R&> && has_trait_front<R&> && has_trait_advance<R&> )
+            >
+    auto constexpr
+    end        (R       &)
+#if defined(__cpp_range_based_for) && __cpp_range_based_for >= 201603L
+    -> impl:: range_for_sentinel
+    {   return {}; }
+#else
+    -> impl:: range_for_iterator<R>
+    {   return { nullptr }; }
+#endif
+
 
     /* Two overloads for 'pull'.
      *  1. has 'pull' in its trait
@@ -441,6 +727,295 @@ namespace orange {
         lookup_traits<R>::front(r);
         lookup_traits<R>::advance(r);
     }
+
+
+    /*  pull_n
+     *  ======
+     *      Pull up to 'n' values into 'out', returning how many were written.
+     *  A return value less than 'n' means the range is now empty.
+     *      If the trait has 'pull_n', we use it. Otherwise we synthesize it,
+     *  one item at a time, from 'empty' and 'pull'.
+     */
+    template<typename R, typename T
+            , SFINAE_ENABLE_IF_CHECK( has_trait_pull_n<R&, T> )
+            >
+    auto constexpr
+    pull_n     (R       &r, T *out, size_t n)
+    -> size_t
+    { return lookup_traits<R>::pull_n   (r, out, n); }
+
+    template<typename R, typename T
+            , SFINAE_ENABLE_IF_CHECK( !has_trait_pull_n<R&, T> )
+            >
+    auto constexpr
+    pull_n     (R       &r, T *out, size_t n)
+    -> size_t
+    {
+        size_t i = 0;
+        for(; i<n && !orange::empty(r); ++i)
+            out[i] = orange::pull(r);
+        return i;
+    }
+
+    /*  advance_n, front_at
+     *  ===================
+     *      'advance_n(r, n)' skips up to 'n' items, returning how many were
+     *  skipped. Ranges with random access have it in their trait, and then
+     *  it's O(1). Otherwise it's synthesized, one 'advance' at a time.
+     *      'front_at(r, i)' is the item 'i' places after the front, without
+     *  advancing. It's only taken from the trait, and 'i' must be less
+     *  than the 'size'.
+     */
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( has_trait_advance_n<R&> )
+            >
+    auto constexpr
+    advance_n  (R       &r, size_t n)
+    -> size_t
+    { return lookup_traits<R>::advance_n(r, n); }
+
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( !has_trait_advance_n<R&> && has_trait_advance<R&> )
+            >
+    auto constexpr
+    advance_n  (R       &r, size_t n)
+    -> size_t
+    {
+        size_t i = 0;
+        for(; i<n && !orange::empty(r); ++i)
+            orange::advance(r);
+        return i;
+    }
+
+    template<typename R>
+    auto constexpr
+    front_at   (R       &r, size_t i)
+    ->decltype(lookup_traits<R>::front_at(r, i))
+    {   return lookup_traits<R>::front_at(r, i); }
+
+    // the size of the blocks used by '|accumulate' and '|collect'
+    // when draining ranges that have 'pull_n' in their trait.
+    constexpr size_t pull_n_block_size = 256;
+
+    /*  can_pull_in_blocks
+     *  ==================
+     *      A range can be drained in blocks if its trait has 'pull_n' (i.e.
+     *  it's not merely synthesized) and its values can sit in a plain array.
+     */
+    template<typename R>
+    using pull_type_t = decltype( orange::pull(std::declval<R&>()) );
+
+    auto checker_for__can_pull_in_blocks    = [](auto&&r)->std::enable_if_t<
+                    std::is_default_constructible<decltype(orange::pull(r))>{}
+                &&  has_trait_pull_n<decltype(r), decltype(orange::pull(r))>
+            >{};
+    template<typename R> constexpr bool
+    can_pull_in_blocks  = orange_utils:: is_invokable_v<decltype(checker_for__can_pull_in_blocks), R&>;
+
+    /*  can_map_in_blocks
+     *  =================
+     *      '|mapr|' and '|filter|' pull a block from the range under them,
+     *  and then call their function on the copies in the block. That's only
+     *  the same as calling it on 'front' if 'front' is a value, not a
+     *  reference into the range, and the copy is cheap if it's trivially
+     *  copyable. Otherwise they're drained one by one.
+     */
+    template<typename R> constexpr bool
+    can_map_in_blocks   =   can_pull_in_blocks<R>
+                        && !std::is_reference<decltype(orange::front(std::declval<R&>()))>{}
+                        &&  std::is_trivially_copyable<pull_type_t<R>>{};
+
+
+    /*  size_hint_t
+     *  ===========
+     *      What we know about how many items remain in a range. Some ranges
+     *  know exactly ('exact'), others can only tell us a bound. For example,
+     *  '|filter|' can never give more items than its underlying range, so it
+     *  reports an 'upper_bound'.
+     */
+    enum class enum_size_hint
+                {   unknown     // m_n is meaningless
+                ,   exact
+                ,   lower_bound // at least m_n items remain
+                ,   upper_bound // at most m_n items remain
+                };
+
+    struct size_hint_t {
+        enum_size_hint  m_kind;
+        size_t          m_n;
+    };
+
+    // 'size' is only for ranges which know exactly how many items remain
+    template<typename R>
+    auto constexpr
+    size       (R       &r)
+    ->decltype(lookup_traits<R>::size   (r))
+    {   return lookup_traits<R>::size   (r); }
+
+    /* Three overloads for 'size_hint'.
+     *  1. has 'size_hint' in its trait
+     *  2. doesn't have 'size_hint' but does have 'size', hence it's exact
+     *  3. neither, so we know nothing
+     */
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( has_trait_size_hint<R&> )
+            >
+    auto constexpr
+    size_hint  (R       &r)
+    -> size_hint_t
+    { return lookup_traits<R>::size_hint(r); }
+
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( !has_trait_size_hint<R&> && has_trait_size<R&> )
+            >
+    auto constexpr
+    size_hint  (R       &r)
+    -> size_hint_t
+    { return { enum_size_hint::exact, static_cast<size_t>(lookup_traits<R>::size(r)) }; }
+
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( !has_trait_size_hint<R&> && !has_trait_size<R&> )
+            >
+    auto constexpr
+    size_hint  (R       &)
+    -> size_hint_t
+    { return { enum_size_hint::unknown, 0 }; }
+
+    /* Helpers for adaptors to build their own size_hint from their
+     * underlying range(s)
+     */
+
+    // 'as_upper_bound', for adaptors like '|filter|' that may drop items
+    constexpr size_hint_t
+    as_upper_bound(size_hint_t h) {
+        if( h.m_kind == enum_size_hint::exact || h.m_kind == enum_size_hint::upper_bound )
+            return { enum_size_hint::upper_bound, h.m_n };
+        return { enum_size_hint::unknown, 0 };
+    }
+
+    // 'min_size_hint', for 'zip', which stops at the shortest range
+    constexpr size_hint_t
+    min_size_hint(size_hint_t a, size_hint_t b) {
+        bool a_above = a.m_kind == enum_size_hint::exact || a.m_kind == enum_size_hint::upper_bound;
+        bool b_above = b.m_kind == enum_size_hint::exact || b.m_kind == enum_size_hint::upper_bound;
+        bool a_below = a.m_kind == enum_size_hint::exact || a.m_kind == enum_size_hint::lower_bound;
+        bool b_below = b.m_kind == enum_size_hint::exact || b.m_kind == enum_size_hint::lower_bound;
+        size_t smaller = a.m_n < b.m_n ? a.m_n : b.m_n;
+
+        if( a.m_kind == enum_size_hint::exact && b.m_kind == enum_size_hint::exact )
+            return { enum_size_hint::exact, smaller };
+        if( a.m_kind == enum_size_hint::exact && b.m_kind == enum_size_hint::lower_bound && b.m_n >= a.m_n )
+            return { enum_size_hint::exact, a.m_n };
+        if( b.m_kind == enum_size_hint::exact && a.m_kind == enum_size_hint::lower_bound && a.m_n >= b.m_n )
+            return { enum_size_hint::exact, b.m_n };
+        if( a_below && b_below )
+            return { enum_size_hint::lower_bound, smaller };
+        if( a_above && b_above )
+            return { enum_size_hint::upper_bound, smaller };
+        if( a_above )
+            return { enum_size_hint::upper_bound, a.m_n };
+        if( b_above )
+            return { enum_size_hint::upper_bound, b.m_n };
+        return { enum_size_hint::unknown, 0 };
+    }
+
+    /*  slice, slice_length, is_sliceable_v
+     *  ==================================
+     *      'slice' is taken directly from the trait. 'slice_length' is taken
+     *  from the trait if present, otherwise it's the 'size'.
+     *  A range is sliceable if it has both.
+     */
+    template<typename R>
+    auto constexpr
+    slice      (R       &r, size_t b, size_t e)
+    ->decltype(lookup_traits<R>::slice  (r, b, e))
+    {   return lookup_traits<R>::slice  (r, b, e); }
+
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( has_trait_slice_length<R&> )
+            >
+    auto constexpr
+    slice_length (R     &r)
+    -> size_t
+    { return lookup_traits<R>::slice_length(r); }
+
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( !has_trait_slice_length<R&> && has_trait_slice<R&> && has_trait_size<R&> )
+            >
+    auto constexpr
+    slice_length (R     &r)
+    -> size_t
+    { return static_cast<size_t>(lookup_traits<R>::size(r)); }
+
+    auto checker_for__is_sliceable=[](auto&&r)->decltype(void( orange::slice(r, size_t(0), size_t(0)) ), void( orange::slice_length(r) )){};
+
+    template<typename R> constexpr bool
+    is_sliceable_v = orange_utils:: is_invokable_v<decltype(checker_for__is_sliceable), R&>;
+
+    /*  data, is_contiguous_iterator_v
+     *  ==============================
+     *      'data' points to the remaining items, where they are contiguous in
+     *  memory. It's only in the trait of ranges that know this, such as
+     *  'as_range' of a vector or an array.
+     */
+    template<typename R>
+    auto constexpr
+    data       (R       &r)
+    ->decltype(lookup_traits<R>::data   (r))
+    {   return lookup_traits<R>::data   (r); }
+
+    namespace impl {
+        template<typename It, typename V
+                , bool can_be_in_a_vector = std::is_object<V>{} && !std::is_array<V>{} && !std::is_abstract<V>{} >
+        struct is_vector_iterator : std::false_type {};
+        template<typename It, typename V>
+        struct is_vector_iterator<It, V, true>
+            : std::integral_constant<bool,     std::is_same<It, typename std::vector<V>::iterator      >{}
+                                            || std::is_same<It, typename std::vector<V>::const_iterator>{} > {};
+    }
+
+    /*  front_mapped
+     *  ============
+     *      'front_mapped(r, f)' is 'f(front(r))', and is what '|mapr|' uses.
+     *  A range can provide it in its trait, to call 'f' without first
+     *  building the front. 'zip_columns' does this for 'apply_pack'.
+     */
+    template<typename R, typename F
+            , SFINAE_ENABLE_IF_CHECK( has_trait_front_mapped<R&, F&> )
+            >
+    auto constexpr
+    front_mapped (R     &r, F &f)
+    ->decltype(lookup_traits<R>::front_mapped(r, f))
+    {   return lookup_traits<R>::front_mapped(r, f); }
+
+    template<typename R, typename F
+            , SFINAE_ENABLE_IF_CHECK( !has_trait_front_mapped<R&, F&> )
+            >
+    auto constexpr
+    front_mapped (R     &r, F &f)
+    ->decltype(f(orange::front(r)))
+    {   return f(orange::front(r)); }
+
+    // Pointers, and the iterators of 'vector' and 'string'. There's no way
+    // to detect this in general before C++20's 'contiguous_iterator'. The
+    // iterators of 'vector<bool>' give proxies or copies, not references.
+    template<typename It>
+    constexpr bool
+    is_contiguous_iterator_v =     std::is_pointer<It>{}
+                                || std::is_same<It, std::string::iterator      >{}
+                                || std::is_same<It, std::string::const_iterator>{}
+                                || (    std::is_lvalue_reference<decltype(*std::declval<It&>())>{}
+                                    &&  impl:: is_vector_iterator<It, std::remove_cv_t<std::remove_reference_t<decltype(*std::declval<It&>())>>>{} );
+
+    // 'reserve_for_size_hint'. Only reserve when we know we'll need at least
+    // that much. An upper bound, for example from '|filter|', might be far
+    // too big.
+    template<typename V>
+    void
+    reserve_for_size_hint(V & v, size_hint_t h) {
+        if( h.m_kind == enum_size_hint::exact || h.m_kind == enum_size_hint::lower_bound )
+            v.reserve( v.size() + h.m_n );
+    }
 }
 
 
@@ -472,6 +1047,17 @@ namespace orange {
         template<typename R> static constexpr
         decltype(auto)
         front           (R & r)   { return * r.first ;}
+
+        // as an output range
+        template<typename R> static constexpr
+        bool
+        full            (R & r)   { return r.first == r.second ;}
+
+        template<typename R, typename T> static
+        auto
+        push            (R & r, T && t)
+        ->decltype(void( *r.first = std::forward<T>(t) ))
+        {   *r.first = std::forward<T>(t); ++ r.first; }
     };
 
 
@@ -481,6 +1067,9 @@ namespace orange {
         static_assert( has_trait_empty    < std::pair<int*, int*> > , "");
         static_assert( has_trait_front    < std::pair<int*, int*> > , "");
         static_assert(!has_trait_front    < std::vector<int> > , "");
+        static_assert( has_trait_full     < std::pair<int*, int*> > , "");
+        static_assert( has_trait_push     < std::pair<int*, int*>, int > , "");
+        static_assert(!has_trait_push     < std::pair<int const*, int const*>, int > , "");
     }
 
 
@@ -532,6 +1121,11 @@ namespace orange {
         ->decltype(R:: orange_pull     (r))
         {   return R:: orange_pull     (r); }
 
+        template<typename R, typename U> static constexpr auto
+        pull_n     (R &  r, U *out, size_t n)
+        ->decltype(R:: orange_pull_n   (r, out, n))
+        {   return R:: orange_pull_n   (r, out, n); }
+
         template<typename R> static constexpr auto
         begin      (R &  r)
         ->decltype(R:: orange_begin    (r))
@@ -541,6 +1135,56 @@ namespace orange {
         end        (R &  r)
         ->decltype(R:: orange_end      (r))
         {   return R:: orange_end      (r); }
+
+        template<typename R> static constexpr auto
+        size       (R &  r)
+        ->decltype(R:: orange_size     (r))
+        {   return R:: orange_size     (r); }
+
+        template<typename R> static constexpr auto
+        size_hint  (R &  r)
+        ->decltype(R:: orange_size_hint(r))
+        {   return R:: orange_size_hint(r); }
+
+        template<typename R> static constexpr auto
+        slice      (R &  r, size_t b, size_t e)
+        ->decltype(R:: orange_slice    (r, b, e))
+        {   return R:: orange_slice    (r, b, e); }
+
+        template<typename R> static constexpr auto
+        slice_length (R &  r)
+        ->decltype(R:: orange_slice_length(r))
+        {   return R:: orange_slice_length(r); }
+
+        template<typename R> static constexpr auto
+        data       (R &  r)
+        ->decltype(R:: orange_data     (r))
+        {   return R:: orange_data     (r); }
+
+        template<typename R, typename F> static constexpr auto
+        front_mapped (R &  r, F &f)
+        ->decltype(R:: orange_front_mapped(r, f))
+        {   return R:: orange_front_mapped(r, f); }
+
+        template<typename R> static constexpr auto
+        advance_n  (R &  r, size_t n)
+        ->decltype(R:: orange_advance_n(r, n))
+        {   return R:: orange_advance_n(r, n); }
+
+        template<typename R> static constexpr auto
+        front_at   (R &  r, size_t i)
+        ->decltype(R:: orange_front_at (r, i))
+        {   return R:: orange_front_at (r, i); }
+
+        template<typename R> static constexpr auto
+        full       (R &  r)
+        ->decltype(R:: orange_full     (r))
+        {   return R:: orange_full     (r); }
+
+        template<typename R, typename U> static constexpr auto
+        push       (R &  r, U && u)
+        ->decltype(R:: orange_push     (r, std::forward<U>(u)))
+        {   return R:: orange_push     (r, std::forward<U>(u)); }
     };
 }
 
@@ -586,6 +1230,41 @@ namespace orange {
 
         template<typename R> static constexpr
         auto orange_end        (R &  r)   { return impl:: iter_is_own_value<T>{r.m_end  };}
+
+        template<typename R> static constexpr
+        auto orange_size       (R &  r)
+        ->decltype(static_cast<size_t>(r.m_end - r.m_begin))
+        {   return r.m_end < r.m_begin ? 0 : static_cast<size_t>(r.m_end - r.m_begin); }
+
+        template<typename R, typename U> static constexpr
+        auto orange_pull_n     (R &  r, U *out, size_t n)
+        ->decltype(orange_size(r))
+        {
+            size_t count = orange_size(r);
+            if(count > n) count = n;
+            for(size_t i = 0; i<count; ++i)
+                out[i] = r.m_begin + static_cast<T>(i);
+            r.m_begin += static_cast<T>(count);
+            return count;
+        }
+
+        template<typename R> static constexpr
+        auto orange_advance_n  (R &  r, size_t n)
+        ->decltype(orange_size(r))
+        {
+            size_t count = orange_size(r);
+            if(count > n) count = n;
+            r.m_begin += static_cast<T>(count);
+            return count;
+        }
+
+        template<typename R> static constexpr
+        T    orange_front_at   (R &  r, size_t i)   { return r.m_begin + static_cast<T>(i); }
+
+        template<typename R> static constexpr
+        auto orange_slice      (R &  r, size_t b, size_t e)
+        ->pair_of_values
+        {   return { r.m_begin + static_cast<T>(b), r.m_begin + static_cast<T>(e) }; }
     };
 
     struct intsFrom0_t
@@ -622,6 +1301,21 @@ namespace orange {
         orange_advance    (R &r) ->void             { --r.m_n; }
         template<typename R> static constexpr auto
         orange_front      (R &r) ->T                { return r.m_t; }
+        template<typename R> static constexpr auto
+        orange_size       (R &r) ->size_t           { return r.m_n <= 0 ? 0 : static_cast<size_t>(r.m_n); }
+        template<typename R> static constexpr auto
+        orange_advance_n  (R &r, size_t n) ->size_t
+        {
+            size_t count = orange_size(r);
+            if(count > n) count = n;
+            r.m_n -= static_cast<int64_t>(count);
+            return count;
+        }
+        template<typename R> static constexpr auto
+        orange_front_at   (R &r, size_t) ->T        { return r.m_t; }
+        template<typename R> static constexpr auto
+        orange_slice      (R &r, size_t b, size_t e) ->replicate_t
+        { return { static_cast<int64_t>(e) - static_cast<int64_t>(b), r.m_t }; }
     };
 
     template<typename T>
@@ -635,6 +1329,86 @@ namespace orange {
     { return replicate_t<T>{std::numeric_limits<int64_t>::max(),std::move(t)}; }
 
 
+    /*  static_size_of<R>
+     *  =================
+     *      Where the number of items is known from the type of the range,
+     *  'value' is that number, and 'exact' is false if it's only a bound. For
+     *  example, after '|filter|' there may be fewer. Otherwise, there's no
+     *  'value'. It's the number of items before any have been advanced over,
+     *  so anything that relies on it checks 'size' first.
+     *
+     *      The sources are rvalue arrays (C arrays or 'std::array'),
+     *  'replicate<N>(t)' and 'ints<N>()'. The range types that keep it are
+     *  listed after each one is defined: '|mapr|', '|filter|', '|take|',
+     *  '|scan|', 'zip' and 'product'. '|collect_static' then returns an
+     *  'std::array' (or a 'static_vector'), with no allocation, and that can
+     *  be done at compile time:
+     *
+     *      constexpr auto squares = ints<16>() |mapr| square_t{} |collect_static;
+     *
+     *  Lvalue arrays are ranges of two pointers, which don't know the size.
+     */
+    template<typename R, typename = void>
+    struct static_size_of {}; // not known
+
+    template<size_t N, bool Exact>
+    struct static_size_is {
+        static constexpr size_t value = N;
+        static constexpr bool   exact = Exact;
+    };
+
+    namespace impl {
+        template<typename R, typename = void>
+        struct has_static_size_impl : public std::false_type {};
+        template<typename R>
+        struct has_static_size_impl<R, orange_utils::void_t< decltype(static_size_of<R>::value) >> : public std::true_type {};
+
+        template<typename R, bool = has_static_size_impl<R>{}>
+        struct has_exact_static_size_impl : public std::false_type {};
+        template<typename R>
+        struct has_exact_static_size_impl<R, true> : public std::integral_constant<bool, static_size_of<R>::exact> {};
+    }
+
+    template<typename R> constexpr bool
+    has_static_size         = impl:: has_static_size_impl       < std::remove_cv_t<std::remove_reference_t<R>> >{};
+    template<typename R> constexpr bool
+    has_exact_static_size   = impl:: has_exact_static_size_impl < std::remove_cv_t<std::remove_reference_t<R>> >{};
+
+    // a loop over these can have a fixed count, visiting each item by 'front_at'
+    template<typename R> constexpr bool
+    can_loop_statically     = has_exact_static_size<R> && has_trait_front_at<R&> && has_trait_size<R&>;
+
+    // 'replicate' with a constant count
+    template<typename T, size_t N>
+    struct replicate_static_t : public replicate_t<T>
+    {
+        constexpr explicit
+        replicate_static_t(T t) : replicate_t<T>{ static_cast<int64_t>(N), std::move(t) } {}
+    };
+    template<typename T, size_t N>
+    struct static_size_of<replicate_static_t<T,N>> : public static_size_is<N, true> {};
+
+    template<size_t N, typename T>
+    auto constexpr
+    replicate(T t)
+    { return replicate_static_t<T,N>{ std::move(t) }; }
+
+    // 'ints' with a constant bound, [0,N)
+    template<size_t N>
+    struct ints_static_t : public pair_of_values<int>
+    {
+        static_assert(N <= size_t(std::numeric_limits<int>::max()) ,"");
+        constexpr
+        ints_static_t() : pair_of_values<int>{ 0, static_cast<int>(N) } {}
+    };
+    template<size_t N>
+    struct static_size_of<ints_static_t<N>> : public static_size_is<N, true> {};
+
+    template<size_t N>
+    constexpr
+    ints_static_t<N> ints() { return {}; }
+
+
 
     /*
      * Next, a 'pair_of_iterators' type in the orange:: namespace. The main (only?)
@@ -688,11 +1462,23 @@ namespace orange {
     -> pair_of_iterators< T*, T* >
     { return {std::begin(v),std::end(v)}; }
 
+    // The constructor tag of the ranges that are built from their items
+    // ('owning_range_for_ye_olde_C_array' and 'merge_t'), so that a single
+    // item is never taken for the argument of a copy or move
+    struct from_items_t { constexpr from_items_t() {} };
+
     template<typename T, size_t N>
     struct owning_range_for_ye_olde_C_array {
         T m_array[N];
         size_t m_offset;
 
+        // A constructor, rather than aggregate initialization, as C++20 doesn't
+        // consider a class with user-declared constructors to be an aggregate
+        template<typename ... Ts>
+        constexpr
+        owning_range_for_ye_olde_C_array    (from_items_t, Ts && ... ts)
+        : m_array{ std::forward<Ts>(ts)... }, m_offset{0} {}
+
         // don't allow this to be copied
         owning_range_for_ye_olde_C_array    (owning_range_for_ye_olde_C_array const &) = delete;
         owning_range_for_ye_olde_C_array &  operator=  (owning_range_for_ye_olde_C_array const &) = delete;
@@ -710,9 +1496,37 @@ namespace orange {
         orange_advance    (M &m) ->void             { ++m.m_offset; }
         template<typename M> static constexpr auto
         orange_front      (M &m) ->decltype(auto)   { return m.m_array[m.m_offset]; }
-    };
-
-
+        template<typename M> static constexpr auto
+        orange_size       (M &m) ->size_t           { return m.m_offset >= N ? 0 : N - m.m_offset; }
+        template<typename M, typename U> static constexpr auto
+        orange_pull_n     (M &m, U *out, size_t n) ->size_t
+        {
+            size_t count = orange_size(m);
+            if(count > n) count = n;
+            for(size_t i = 0; i<count; ++i)
+                out[i] = m.m_array[m.m_offset + i];
+            m.m_offset += count;
+            return count;
+        }
+        template<typename M> static constexpr auto
+        orange_advance_n  (M &m, size_t n) ->size_t
+        {
+            size_t count = orange_size(m);
+            if(count > n) count = n;
+            m.m_offset += count;
+            return count;
+        }
+        template<typename M> static constexpr auto
+        orange_front_at   (M &m, size_t i) ->decltype(auto) { return m.m_array[m.m_offset + i]; }
+        template<typename M> static constexpr auto
+        orange_data       (M &m) ->decltype(auto)   { return &m.m_array[0] + m.m_offset; }
+        // a non-owning slice, pointing into this array
+        template<typename M> static constexpr auto
+        orange_slice      (M &m, size_t b, size_t e)
+        { return pair_of_iterators<decltype(&m.m_array[0]), decltype(&m.m_array[0])>{ &m.m_array[0] + m.m_offset + b, &m.m_array[0] + m.m_offset + e }; }
+    };
+
+
     // an rvalue array. We need a helper function first though:
     template <typename T, std:: size_t N, std:: size_t ... Indices>
     auto constexpr
@@ -720,7 +1534,7 @@ namespace orange {
                                                 , std::index_sequence<Indices...>
                                                 )
     -> owning_range_for_ye_olde_C_array<T,N>
-    { return {{ std::move(a[Indices]) ... },0}; }
+    { return owning_range_for_ye_olde_C_array<T,N>{ from_items_t{}, std::move(a[Indices]) ... }; }
 
     // for rvalue-array, we copy the array via the helper above and then we
     // can store it in a special type, 'owning_range_for_ye_olde_C_array',
@@ -733,6 +1547,29 @@ namespace orange {
         return as_range_helper_for_rvalue_plain_C_arrays(std::move(a), std::make_index_sequence<N>());
     }
 
+    // an rvalue 'std::array' is stored the same way. As an 'owning_range', its
+    // pair of pointers would point into the old array after a move
+    template <typename T, std:: size_t N, std:: size_t ... Indices>
+    auto constexpr
+    as_range_helper_for_rvalue_std_arrays       ( std:: array<T,N> &&a
+                                                , std::index_sequence<Indices...>
+                                                )
+    -> owning_range_for_ye_olde_C_array<T,N>
+    { return owning_range_for_ye_olde_C_array<T,N>{ from_items_t{}, std::get<Indices>(std::move(a)) ... }; }
+
+    template <typename T, std:: size_t N
+            , SFINAE_ENABLE_IF_CHECK( N > 0 ) // 'std::array<T,0>' is the 'owning_range' below
+            >
+    auto constexpr
+    as_range(std:: array<T,N> &&a)
+    -> owning_range_for_ye_olde_C_array<T,N>
+    {
+        return as_range_helper_for_rvalue_std_arrays(std::move(a), std::make_index_sequence<N>());
+    }
+
+    template<typename T, size_t N>
+    struct static_size_of<owning_range_for_ye_olde_C_array<T,N>> : public static_size_is<N, true> {};
+
     // two iterators as arguments
     template <typename T>
     auto constexpr
@@ -740,6 +1577,15 @@ namespace orange {
     ->decltype(pair_of_iterators<   decltype(b) ,   decltype(e) >   {b,e})
     { return {b,e}; }
 
+    namespace impl {
+        // for 'data', we mustn't dereference an iterator at the end
+        template<typename T> constexpr
+        T * address_of_iterator(T * b, T *) { return b; }
+        template<typename It> constexpr
+        auto address_of_iterator(It b, It e) -> decltype(std::addressof(*b))
+        { return b == e ? nullptr : std::addressof(*b); }
+    }
+
     template<typename B, typename E>
     struct traits<pair_of_iterators<B,E>> {
         template<typename R> static constexpr
@@ -759,6 +1605,61 @@ namespace orange {
 
         template<typename R> static constexpr
         auto end        (R & r)   { return r.second; }
+
+        // only for random-access iterators
+        template<typename R> static constexpr
+        auto size       (R & r)
+        ->decltype(static_cast<size_t>(r.second - r.first))
+        {   return static_cast<size_t>(r.second - r.first); }
+
+        // also only for random-access iterators, so the loop below has
+        // a fixed count. Over contiguous memory, this is just a copy.
+        template<typename R, typename T> static constexpr
+        auto pull_n     (R & r, T *out, size_t n)
+        ->decltype(size(r))
+        {
+            size_t count = size(r);
+            if(count > n) count = n;
+            for(size_t i = 0; i<count; ++i)
+                out[i] = r.first[i];
+            r.first += count;
+            return count;
+        }
+
+        // ... and these two, so '|skip|' doesn't step through one at a time
+        template<typename R> static constexpr
+        auto advance_n  (R & r, size_t n)
+        ->decltype(size(r))
+        {
+            size_t count = size(r);
+            if(count > n) count = n;
+            r.first += count;
+            return count;
+        }
+
+        template<typename R> static constexpr
+        auto front_at   (R & r, size_t i)
+        ->decltype(void(size(r)), r.first[i])
+        {   return r.first[i]; }
+
+        template<typename R> static constexpr
+        auto slice      (R & r, size_t b, size_t e)
+        ->decltype(void(size(r)), pair_of_iterators<B,B>{ r.first, r.first })
+        {   return pair_of_iterators<B,B>{ r.first + b, r.first + e }; }
+
+        template<typename R
+                , SFINAE_ENABLE_IF_CHECK( is_contiguous_iterator_v<B> )
+                > static constexpr
+        auto data       (R & r)   { return impl:: address_of_iterator(r.first, r.second); }
+
+        // as an output range, such as 'as_range' of a vector that's already the right size
+        template<typename R> static constexpr
+        bool full       (R & r)   { return r.first == r.second ;}
+
+        template<typename R, typename T> static constexpr
+        auto push       (R & r, T && t)
+        ->decltype(void( *r.first = std::forward<T>(t) ))
+        {   *r.first = std::forward<T>(t); ++ r.first; }
     };
 
     template<typename C>
@@ -799,6 +1700,31 @@ namespace orange {
         template<typename M> static constexpr auto
         orange_front      (M &m) ->decltype(auto)
         { return orange::front    ( m.m_r ) ;}
+        template<typename M> static constexpr auto
+        orange_size       (M &m) ->decltype(orange::size( m.m_r ))
+        { return orange::size     ( m.m_r ) ;}
+        template<typename M> static constexpr auto
+        orange_size_hint  (M &m) ->size_hint_t
+        { return orange::size_hint( m.m_r ) ;}
+        template<typename M, typename U> static constexpr auto
+        orange_pull_n     (M &m, U *out, size_t n) ->decltype(lookup_traits<R>::pull_n( m.m_r, out, n ))
+        { return orange::pull_n   ( m.m_r, out, n ) ;}
+        // the slices don't own anything, they point into this range
+        template<typename M> static constexpr auto
+        orange_slice      (M &m, size_t b, size_t e) ->decltype(orange::slice( m.m_r, b, e ))
+        { return orange::slice    ( m.m_r, b, e ) ;}
+        template<typename M> static constexpr auto
+        orange_slice_length (M &m) ->decltype(orange::slice_length( m.m_r ))
+        { return orange::slice_length( m.m_r ) ;}
+        template<typename M> static constexpr auto
+        orange_data       (M &m) ->decltype(orange::data( m.m_r ))
+        { return orange::data     ( m.m_r ) ;}
+        template<typename M> static constexpr auto
+        orange_advance_n  (M &m, size_t n) ->decltype(lookup_traits<R>::advance_n( m.m_r, n ))
+        { return orange::advance_n( m.m_r, n ) ;}
+        template<typename M> static constexpr auto
+        orange_front_at   (M &m, size_t i) ->decltype(orange::front_at( m.m_r, i ))
+        { return orange::front_at ( m.m_r, i ) ;}
     };
 
     // as_range, for rvalues that aren't ranges. In this case, we wrap them
@@ -845,14 +1771,36 @@ namespace orange {
 
     struct collect_tag_t{constexpr collect_tag_t(){}};
                                         constexpr            collect_tag_t          collect;    // no need for 'tagger_t', this directly runs
+    struct collect_static_tag_t{constexpr collect_static_tag_t(){}};
+                                        constexpr            collect_static_tag_t   collect_static;    // no need for 'tagger_t', this directly runs
     struct discard_collect_tag_t{constexpr discard_collect_tag_t(){}};
                                         constexpr            discard_collect_tag_t  discard_collect;    // no need for 'tagger_t', this directly runs
     struct accumulate_tag_t{constexpr accumulate_tag_t(){}};
                                         constexpr            accumulate_tag_t       accumulate;    // no need for 'tagger_t', this directly runs
+    struct accumulate_in_lanes_tag_t{constexpr accumulate_in_lanes_tag_t(){}};
+                                        constexpr            accumulate_in_lanes_tag_t accumulate_in_lanes;    // no need for 'tagger_t', this directly runs
     struct concat_tag_t{constexpr concat_tag_t(){}};
                                         constexpr            concat_tag_t           concat;    // no need for 'tagger_t', this directly runs
     struct memoize_tag_t{constexpr memoize_tag_t(){}};
                                         constexpr            memoize_tag_t           memoize;    // no need for 'tagger_t', this directly runs
+    template<size_t K>
+    struct memoize_n_tag_t{constexpr memoize_n_tag_t(){}};
+    template<size_t K>                  constexpr            memoize_n_tag_t<K>      memoize_n;  // no need for 'tagger_t', this directly runs
+
+    struct merge_all_tag_t{constexpr merge_all_tag_t(){}};
+                                        constexpr            merge_all_tag_t         merge_all;  // no need for 'tagger_t', this directly runs
+    struct chunk_tag_t          {};     constexpr   tagger_t<chunk_tag_t        >   chunk;
+    struct group_by_tag_t       {};     constexpr   tagger_t<group_by_tag_t     >   group_by;
+    struct take_tag_t           {};     constexpr   tagger_t<take_tag_t         >   take;
+    struct skip_tag_t           {};     constexpr   tagger_t<skip_tag_t         >   skip;
+    struct scan_tag_t           {};     constexpr   tagger_t<scan_tag_t         >   scan;
+    struct copy_to_tag_t        {};     constexpr   tagger_t<copy_to_tag_t      >   copy_to;
+    struct write_to_tag_t       {};     constexpr   tagger_t<write_to_tag_t     >   write_to;
+    struct find_if_tag_t        {};     constexpr   tagger_t<find_if_tag_t      >   find_if;
+    struct any_of_tag_t         {};     constexpr   tagger_t<any_of_tag_t       >   any_of;
+    struct all_of_tag_t         {};     constexpr   tagger_t<all_of_tag_t       >   all_of;
+    struct min_max_tag_t{constexpr min_max_tag_t(){}};
+                                        constexpr            min_max_tag_t           min_max;    // no need for 'tagger_t', this directly runs
 
 
     // the type to capture the value, i.e. for the left-hand '|'
@@ -909,19 +1857,358 @@ namespace orange {
 
     // |foreach|
     // =========
+    namespace impl {
+        template<typename R, typename Func>
+        constexpr void
+        foreach_one_by_one(R & r, Func & func)
+        {
+            while(!orange::empty(r)) {
+                func(orange::front(r));
+                orange::advance(r);
+            }
+        }
+    }
+
+    template<typename R, typename Func
+            , SFINAE_ENABLE_IF_CHECK( !can_loop_statically<R> )
+            >
+    constexpr auto
+    operator| (forward_this_with_a_tag<R,foreach_tag_t> r, Func && func)
+    -> void
+    {
+        impl:: foreach_one_by_one(r.m_r, func);
+    }
+
+    // the count is a constant, so the compiler can unroll this loop
     template<typename R, typename Func
+            , SFINAE_ENABLE_IF_CHECK( can_loop_statically<R> )
             >
     constexpr auto
     operator| (forward_this_with_a_tag<R,foreach_tag_t> r, Func && func)
     -> void
     {
-        while(!orange::empty(r.m_r)) {
-            func(orange::front(r.m_r));
-            orange::advance(r.m_r);
+        if(orange::size(r.m_r) != static_size_of<R>::value) // some have been advanced over already
+            return impl:: foreach_one_by_one(r.m_r, func);
+        for(size_t i = 0; i<static_size_of<R>::value; ++i)
+            func(orange::front_at(r.m_r, i));
+    }
+
+
+    /*  |copy_to| sink
+     *  ==============
+     *      Writes the items into an output range, until the range is empty or
+     *  the sink is 'full', and returns how many were written. The sink is an
+     *  output range (with 'push' and 'full'), or a container that 'as_range'
+     *  can write into, such as a vector that's already the right size. An
+     *  output range that's passed as an lvalue is advanced in place, so that
+     *  more can be written to it afterwards:
+     *
+     *      std:: vector<int> out(100);
+     *      auto o = as_range(out);
+     *      a |copy_to| o;
+     *      b |copy_to| o;   // after the items of 'a'
+     *
+     *      When both have 'data' and 'size', and the same trivially copyable
+     *  type, it's one 'std::copy_n' (which is a 'memmove') of all that fits.
+     */
+    namespace impl {
+        template<typename R, typename S>
+        constexpr bool
+        can_copy_all_at_once_impl(orange_utils:: priority_tag<0>)  {
+            return false;
+        }
+        template<typename R, typename S
+                , typename Source = std::remove_cv_t<std::remove_pointer_t<decltype(orange::data(std::declval<R&>()))>>
+                , typename Target =                  std::remove_pointer_t<decltype(orange::data(std::declval<S&>()))>
+                , typename = decltype( orange::size(std::declval<R&>()) + orange::size(std::declval<S&>()) )
+                >
+        constexpr bool
+        can_copy_all_at_once_impl(orange_utils:: priority_tag<1>)  {
+            return std::is_same<Source, Target>{} && std::is_trivially_copyable<Target>{};
+        }
+        template<typename R, typename S>
+        constexpr bool
+        can_copy_all_at_once()  {
+            return can_copy_all_at_once_impl<R, S>(orange_utils:: priority_tag<9>{});
+        }
+
+        template<typename R, typename S
+                , SFINAE_ENABLE_IF_CHECK( can_copy_all_at_once<R, S>() )
+                >
+        size_t
+        copy_into(R & r, S & sink) {
+            size_t const n = std::min<size_t>( orange::size(r), orange::size(sink) );
+            if(n > 0)
+                std:: copy_n( orange::data(r), n, orange::data(sink) );
+            orange::advance_n(r, n);
+            orange::advance_n(sink, n);
+            return n;
+        }
+
+        template<typename R, typename S
+                , SFINAE_ENABLE_IF_CHECK( !can_copy_all_at_once<R, S>() )
+                >
+        size_t
+        copy_into(R & r, S & sink) {
+            size_t n = 0;
+            for(; !orange::empty(r) && !orange::full(sink); orange::advance(r), ++n)
+                orange::push(sink, orange::front(r));
+            return n;
+        }
+    }
+
+    template<typename R, typename S
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<std::remove_reference_t<S>> )
+            >
+    size_t
+    operator| (forward_this_with_a_tag<R,copy_to_tag_t> f, S && sink)
+    {   return impl:: copy_into(f.m_r, sink); }
+
+    template<typename R, typename C
+            , SFINAE_ENABLE_IF_CHECK( !is_range_v<C> )
+            >
+    size_t
+    operator| (forward_this_with_a_tag<R,copy_to_tag_t> f, C & container)
+    {
+        auto sink = as_range(container);
+        return impl:: copy_into(f.m_r, sink);
+    }
+
+    /*  ostream_sink<Stream>   |write_to| stream
+     *  ========================================
+     *      An output range over a 'std::ostream' (or any 'Stream' of 'char'),
+     *  writing each item followed by a separator. '|write_to| stream' is a
+     *  '|copy_to|' into one of these, with "\n" as the separator.
+     *      Rather than a '<<' on the stream for each item, integers, 'char's
+     *  and strings are formatted into a buffer, and the stream only gets one
+     *  'write' per buffer-full, and when the sink is flushed or destroyed.
+     *  Other types, and everything when the stream's flags aren't the
+     *  defaults (as after 'std::hex' or 'std::setw'), still go through '<<',
+     *  after first writing out the buffer, so the order is kept.
+     */
+    template<typename Stream>
+    class ostream_sink {
+        static_assert(std::is_same<typename Stream:: char_type, char>{}, "");
+
+        Stream *        m_os;
+        char const *    m_sep;
+        size_t          m_sep_length;
+        size_t          m_used;
+        char            m_buffer[4096];
+
+        void
+        append(char const * p, size_t n) {
+            if(m_used + n > sizeof(m_buffer)) {
+                flush();
+                if(n > sizeof(m_buffer)) {
+                    m_os->write(p, static_cast<std::streamsize>(n));
+                    return;
+                }
+            }
+            std:: copy_n(p, n, m_buffer + m_used);
+            m_used += n;
+        }
+
+        bool
+        has_default_format() const {
+            return      (m_os->flags() & (Stream:: basefield | Stream:: showpos)) == Stream:: dec
+                    &&  m_os->width() == 0;
+        }
+
+        template<typename I
+                , SFINAE_ENABLE_IF_CHECK( std::is_signed<I>{} ) >
+        static bool
+        is_negative(I x) { return x < 0; }
+        template<typename I
+                , SFINAE_ENABLE_IF_CHECK(!std::is_signed<I>{} ) >
+        static bool
+        is_negative(I  ) { return false; }
+
+        // integers, in decimal, written backwards from the end of a small array
+        template<typename I
+                , SFINAE_ENABLE_IF_CHECK(       std::is_integral<I>{}
+                                            && !std::is_same<I, bool>{}
+                                            && !std::is_same<I, char>{} && !std::is_same<I, signed char>{} && !std::is_same<I, unsigned char>{}
+                                            &&  sizeof(I) <= sizeof(unsigned long long) )
+                >
+        void
+        write_item(I x, orange_utils:: priority_tag<2>) {
+            char    digits[24];
+            char *  p = digits + sizeof(digits);
+            unsigned long long u = is_negative(x) ? 0ull - static_cast<unsigned long long>(x) : static_cast<unsigned long long>(x);
+            do {
+                *--p = static_cast<char>('0' + u % 10);
+                u /= 10;
+            } while(u);
+            if(is_negative(x))
+                *--p = '-';
+            append(p, static_cast<size_t>(digits + sizeof(digits) - p));
+        }
+        template<typename C
+                , SFINAE_ENABLE_IF_CHECK( std::is_same<C, char>{} ) >
+        void
+        write_item(C c, orange_utils:: priority_tag<2>)             { append(&c, 1); }
+        template<typename C
+                , SFINAE_ENABLE_IF_CHECK( std::is_same<C, char>{} ) >
+        void
+        write_item(C const * s, orange_utils:: priority_tag<2>)     { append(s, std::char_traits<char>::length(s)); }
+
+        // strings, and anything else with 'data' and 'size' that '<<' would print as a string
+        template<typename S
+                , SFINAE_ENABLE_IF_CHECK( std::is_same<decltype(std::declval<S const &>().data()), char const *>{}
+                                       && std::is_same<typename S:: traits_type, std::char_traits<char>>{} ) >
+        void
+        write_item(S const & s, orange_utils:: priority_tag<1>)     { append(s.data(), s.size()); }
+
+        template<typename T>
+        void
+        write_item(T const & x, orange_utils:: priority_tag<0>)     { flush(); *m_os << x; }
+
+    public:
+        explicit
+        ostream_sink(Stream & os, char const * separator = "\n")
+        : m_os(&os), m_sep(separator), m_sep_length(std::char_traits<char>::length(separator)), m_used(0) {}
+
+        ostream_sink(ostream_sink const &)              = delete;   // a copy would write the buffer twice
+        ostream_sink & operator= (ostream_sink const &) = delete;
+        ostream_sink(ostream_sink && other)
+        : m_os(other.m_os), m_sep(other.m_sep), m_sep_length(other.m_sep_length), m_used(other.m_used)
+        {
+            std:: copy_n(other.m_buffer, m_used, m_buffer);
+            other.m_used = 0;
+        }
+        ~ostream_sink() { flush(); }
+
+        void
+        flush() {
+            if(m_used > 0)
+                m_os->write(m_buffer, static_cast<std::streamsize>(m_used));
+            m_used = 0;
+        }
+
+        template<typename T>
+        void
+        write(T const & x) {
+            if(has_default_format())
+                write_item(x, orange_utils:: priority_tag<9>{});
+            else
+                write_item(x, orange_utils:: priority_tag<0>{});
+            append(m_sep, m_sep_length);
         }
+
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+
+        template<typename M> static bool
+        orange_full       (M &m) { return !*m.m_os; }
+        template<typename M, typename T> static auto
+        orange_push       (M &m, T const & x)
+        ->decltype(void( std::declval<Stream&>() << x ))
+        {   m.write(x); }
+    };
+
+    template<typename Stream>
+    ostream_sink<Stream>
+    make_ostream_sink(Stream & os, char const * separator = "\n")
+    {   return ostream_sink<Stream>{ os, separator }; }
+
+    template<typename R, typename Stream
+            , SFINAE_ENABLE_IF_CHECK( std::is_same<typename Stream:: char_type, char>{} )
+            >
+    size_t
+    operator| (forward_this_with_a_tag<R,write_to_tag_t> f, Stream & os)
+    {
+        ostream_sink<Stream> sink(os);
+        return impl:: copy_into(f.m_r, sink);
     }
 
 
+    namespace impl {
+        /*  composed_function<F,G>
+         *      'g(f(x))'. A '|mapr|' straight after another '|mapr|' stores
+         *  this, rather than wrapping one 'mapping_range' in another.
+         */
+        template<typename F, typename G>
+        struct composed_function {
+            F m_f;
+            G m_g;
+
+            template<typename ... Args>
+            constexpr auto
+            operator() (Args && ... args)
+            ->decltype(std::declval<G&>()(std::declval<F&>()(std::forward<Args>(args)...)))
+            {   return m_g(m_f(std::forward<Args>(args)...)); }
+
+            template<typename ... Args>
+            constexpr auto
+            operator() (Args && ... args) const
+            ->decltype(std::declval<G const &>()(std::declval<F const &>()(std::forward<Args>(args)...)))
+            {   return m_g(m_f(std::forward<Args>(args)...)); }
+        };
+
+        // The innermost function of a composition is given to 'front_mapped'
+        // on the range, as it might be able to do better than 'f(front(r))'
+        template<typename R, typename F>
+        constexpr auto
+        front_mapped_through    (R &r, F &f)
+        ->decltype(orange::front_mapped(r, f))
+        {   return orange::front_mapped(r, f); }
+
+        template<typename R, typename F, typename G>
+        constexpr auto
+        front_mapped_through    (R &r, composed_function<F,G> &c)
+        ->decltype(c.m_g(front_mapped_through(r, c.m_f)))
+        {   return c.m_g(front_mapped_through(r, c.m_f)); }
+
+        template<typename R, typename F, typename G>
+        constexpr auto
+        front_mapped_through    (R &r, composed_function<F,G> const &c)
+        ->decltype(c.m_g(front_mapped_through(r, c.m_f)))
+        {   return c.m_g(front_mapped_through(r, c.m_f)); }
+
+        /*  mapping_iterator<It, F>
+         *      The 'begin' and 'end' of a '|mapr|' over a range that has them.
+         *  It points at the function inside the 'mapping_range', so it's only
+         *  valid while that range is. It has whatever random access 'It' has,
+         *  which is what 'zip' uses for its own iterators.
+         */
+        template<typename It, typename F>
+        struct mapping_iterator {
+            It  m_it;
+            F * m_f;
+
+            constexpr decltype(auto)
+            operator*  ()                                       const { return (*m_f)(*m_it); }
+            constexpr mapping_iterator &
+            operator++ ()                                             { ++m_it; return *this; }
+
+            template<typename J>
+            constexpr bool
+            operator== (mapping_iterator<J,F> const & other)    const { return m_it == other.m_it; }
+            template<typename J>
+            constexpr bool
+            operator!= (mapping_iterator<J,F> const & other)    const { return m_it != other.m_it; }
+
+            template<typename J = It, typename = decltype( std::declval<J&>() += std::ptrdiff_t(0) )>
+            constexpr mapping_iterator &
+            operator+= (std::ptrdiff_t d)                             { m_it += d; return *this; }
+            template<typename J = It, typename = decltype( std::declval<J const &>() + std::ptrdiff_t(0) )>
+            constexpr mapping_iterator
+            operator+  (std::ptrdiff_t d)                       const { return { m_it + d, m_f }; }
+            template<typename J = It>
+            constexpr auto
+            operator[] (std::ptrdiff_t d)                       const
+            ->decltype( (*m_f)(std::declval<J const &>()[d]) )        { return (*m_f)(m_it[d]); }
+            template<typename J>
+            constexpr auto
+            operator-  (mapping_iterator<J,F> const & other)    const
+            ->decltype( std::declval<It const &>() - other.m_it )     { return m_it - other.m_it; }
+            template<typename J>
+            constexpr auto
+            operator<  (mapping_iterator<J,F> const & other)    const
+            ->decltype( bool(std::declval<It const &>() < other.m_it) ) { return m_it < other.m_it; }
+        };
+    }
+
     // |mapr| or |map_range|
     template<typename R, typename F>
     struct mapping_range {
@@ -938,10 +2225,66 @@ namespace orange {
         orange_advance    (M &m) { orange::advance( m.m_r ) ;}
         template<typename M> static constexpr auto
         orange_front      (M &m)
-        ->decltype(m.m_f(orange::front      ( m.m_r )) )
-        {   return m.m_f(orange::front      ( m.m_r )) ;}
+        ->decltype(impl::front_mapped_through( m.m_r, m.m_f ))
+        {   return impl::front_mapped_through( m.m_r, m.m_f ) ;}
+        template<typename M> static constexpr auto
+        orange_size       (M &m)
+        ->decltype(orange::size             ( m.m_r ))
+        {   return orange::size             ( m.m_r ) ;}
+        template<typename M> static constexpr size_hint_t
+        orange_size_hint  (M &m) { return orange::size_hint( m.m_r ) ;}
+
+        // pull a block from the underlying range, then apply the function to each
+        template<typename M, typename U
+                , SFINAE_ENABLE_IF_CHECK( can_map_in_blocks<R> && orange_utils:: is_invokable_v<F&, pull_type_t<R>&> )
+                > static constexpr size_t
+        orange_pull_n     (M &m, U *out, size_t n)
+        {
+            pull_type_t<R> block[pull_n_block_size] {};
+            size_t written = 0;
+            while(written < n) {
+                size_t want = n - written < pull_n_block_size ? n - written : pull_n_block_size;
+                size_t got = orange::pull_n( m.m_r, block, want );
+                for(size_t i = 0; i<got; ++i)
+                    out[written + i] = m.m_f(block[i]);
+                written += got;
+                if(got < want)
+                    break;
+            }
+            return written;
+        }
+
+        template<typename M> static constexpr auto
+        orange_slice      (M &m, size_t b, size_t e)
+        ->mapping_range< std::decay_t<decltype(orange::slice( m.m_r, b, e ))>, F >
+        {   return { orange::slice( m.m_r, b, e ), m.m_f }; }
+        template<typename M> static constexpr auto
+        orange_slice_length (M &m)
+        ->decltype(orange::slice_length     ( m.m_r ))
+        {   return orange::slice_length     ( m.m_r ) ;}
+
+        // random access, where the underlying range has it
+        template<typename M> static constexpr auto
+        orange_advance_n  (M &m, size_t n)
+        ->decltype(lookup_traits<R>::advance_n( m.m_r, n ))
+        {   return orange::advance_n        ( m.m_r, n ) ;}
+        template<typename M> static constexpr auto
+        orange_front_at   (M &m, size_t i)
+        ->decltype(m.m_f(orange::front_at   ( m.m_r, i )))
+        {   return m.m_f(orange::front_at   ( m.m_r, i )) ;}
+        template<typename M> static constexpr auto
+        orange_begin      (M &m)
+        ->impl::mapping_iterator< decltype(lookup_traits<R>::begin( m.m_r )), std::remove_reference_t<decltype(m.m_f)> >
+        {   return { orange::begin( m.m_r ), &m.m_f }; }
+        template<typename M> static constexpr auto
+        orange_end        (M &m)
+        ->impl::mapping_iterator< decltype(lookup_traits<R>::end  ( m.m_r )), std::remove_reference_t<decltype(m.m_f)> >
+        {   return { orange::end  ( m.m_r ), &m.m_f }; }
     };
 
+    template<typename R, typename F>
+    struct static_size_of<mapping_range<R,F>> : public static_size_of<R> {};
+
     template<typename R, typename Func>
     auto constexpr
     operator| (forward_this_with_a_tag<R,map_tag_t> f, Func && func) {
@@ -952,6 +2295,18 @@ namespace orange {
                               };
     }
 
+    // '|mapr| f |mapr| g' is one 'mapping_range', applying 'g(f(x))'
+    template<typename R, typename F, typename Func>
+    auto constexpr
+    operator| (forward_this_with_a_tag<mapping_range<R,F>,map_tag_t> f, Func && func) {
+        using G = std::remove_reference_t<Func>;
+        return mapping_range<   R
+                            ,   impl::composed_function<F, G>
+                            > { std::move         (f.m_r.m_r)
+                              , impl::composed_function<F, G>{ std::move(f.m_r.m_f), std::forward<Func>(func) }
+                              };
+    }
+
     // |filter|
     template<typename R, typename F>
     struct filter_range
@@ -987,8 +2342,48 @@ namespace orange {
 
         template<typename M> static constexpr void
         orange_advance    (M &m) { orange:: advance(m.m_r); m.skip_if_necessary(); }
+
+        // we can't know how many will pass the filter, but it can't be more than we have
+        template<typename M> static constexpr size_hint_t
+        orange_size_hint  (M &m) { return orange:: as_upper_bound( orange:: size_hint(m.m_r) );}
+
+        // pull blocks from the underlying range, keeping those that pass. We
+        // never pull more than we have room for, as every item might pass.
+        template<typename M, typename U
+                , SFINAE_ENABLE_IF_CHECK( can_map_in_blocks<R> && orange_utils:: is_invokable_v<F&, pull_type_t<R>&> )
+                > static constexpr size_t
+        orange_pull_n     (M &m, U *out, size_t n)
+        {
+            pull_type_t<R> block[pull_n_block_size] {};
+            size_t written = 0;
+            while(written < n && !orange::empty(m.m_r)) {
+                size_t want = n - written < pull_n_block_size ? n - written : pull_n_block_size;
+                size_t got = orange::pull_n( m.m_r, block, want );
+                for(size_t i = 0; i<got; ++i) {
+                    if(m.m_f(block[i]))
+                        out[written++] = std::move(block[i]);
+                }
+            }
+            m.skip_if_necessary();
+            return written;
+        }
+
+        // the positions are those of the underlying range, some of which are dropped
+        template<typename M> static constexpr auto
+        orange_slice      (M &m, size_t b, size_t e)
+        ->filter_range< std::decay_t<decltype(orange::slice( m.m_r, b, e ))>, F >
+        {   return { orange::slice( m.m_r, b, e ), m.m_f }; }
+        template<typename M> static constexpr auto
+        orange_slice_length (M &m)
+        ->decltype(orange::slice_length     ( m.m_r ))
+        {   return orange::slice_length     ( m.m_r ) ;}
     };
 
+    // at most as many as 'R'
+    template<typename R, typename F>
+    struct static_size_of<filter_range<R,F>, orange_utils::void_t< decltype(static_size_of<R>::value) >>
+        : public static_size_is<static_size_of<R>::value, false> {};
+
     template<typename R, typename Func>
     auto constexpr
     operator| (forward_this_with_a_tag<R,filter_tag_t> f, Func && func) {
@@ -999,77 +2394,1351 @@ namespace orange {
                               };
     }
 
-    // |collect|
-    template<typename R
-            , typename Rnonref = std::remove_reference_t<R>
-            , SFINAE_ENABLE_IF_CHECK( is_range_v<Rnonref> )
-            >
-    auto constexpr
-    operator| (R r, collect_tag_t) {
-        static_assert( is_range_v<R> ,"");
-        using value_type = decltype (   orange::pull( r )  );
-        static_assert(!std::is_reference<value_type>{} ,"");
-        std:: vector<value_type> res;
+    /*  |mapr| f |filter| p
+     *      A '|filter|' would call 'front' on the '|mapr|' twice for every item
+     *  that passes, once for the predicate and again for the reader, and so
+     *  'f' would be called twice. Instead, this one range calls 'f' once
+     *  for each item, and keeps the value for 'front'.
+     *      This is only where 'f' returns by value. If 'f' returns a
+     *  reference, there is nothing to save and the usual 'filter_range'
+     *  is used.
+     *      There is no 'lanes_for' this range, as the lanes would have to
+     *  call 'f' once for the predicate and again for the value.
+     */
+    template<typename R, typename F, typename P>
+    struct map_filter_range
+    {
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+        static_assert(!std::is_reference<R>{},"");
+        static_assert(!std::is_reference<F>{},"");
+        static_assert(!std::is_reference<P>{},"");
+        static_assert( is_range_v<R>, "");
 
-        while(!orange::empty(r)) {
-            res.push_back( orange::pull(r) );
+        using val_type = decltype(impl::front_mapped_through(std::declval<R&>(), std::declval<F&>()));
+        static_assert(!std::is_reference<val_type>{} ,"");
+
+        R m_r;
+        F m_f;
+        P m_p;
+        orange_utils:: optional_value<val_type> m_current; // 'f' of the front of 'm_r', which has passed 'p'
+
+        constexpr
+        void
+        skip_if_necessary() {
+            while(!orange::empty(m_r)) {
+                if(m_p(m_current.emplace(impl::front_mapped_through(m_r, m_f))))
+                    return;
+                orange::advance(m_r);
+            }
+            m_current.reset();
         }
 
-        return res;
-    }
+        template<typename RR, typename FF, typename PP>
+        constexpr
+        map_filter_range(RR && r, FF && f, PP && p)
+        : m_r(std::forward<RR>(r)) , m_f(std::forward<FF>(f)) , m_p(std::forward<PP>(p)) , m_current()
+        { skip_if_necessary(); }
 
+        template<typename M> static constexpr bool
+        orange_empty      (M &m) { return !m.m_current.has_value(); }
 
-    // |discard_collect|
-    template<typename R
-            , typename Rnonref = std::remove_reference_t<R>
-            , SFINAE_ENABLE_IF_CHECK( is_range_v<Rnonref> )
-            >
-    void constexpr
-    operator| (R r, discard_collect_tag_t) {
-        static_assert( is_range_v<R> ,"");
+        template<typename M> static constexpr auto
+        orange_front      (M &m)
+        -> val_type&
+        { return *m.m_current; }
 
-        while(!orange::empty(r))
-        { orange::pull(r); }
+        template<typename M> static constexpr void
+        orange_advance    (M &m) { orange:: advance(m.m_r); m.skip_if_necessary(); }
 
-    }
+        template<typename M> static constexpr size_hint_t
+        orange_size_hint  (M &m) { return orange:: as_upper_bound( orange:: size_hint(m.m_r) );}
 
+        // as in 'filter_range', but mapping each item of the block first
+        template<typename M, typename U
+                , SFINAE_ENABLE_IF_CHECK( can_map_in_blocks<R> && orange_utils:: is_invokable_v<F&, pull_type_t<R>&> )
+                > static constexpr size_t
+        orange_pull_n     (M &m, U *out, size_t n)
+        {
+            if(n == 0 || !m.m_current.has_value())
+                return 0;
+            // the front has already been mapped and tested
+            out[0] = std::move(*m.m_current);
+            orange::advance(m.m_r);
+            size_t written = 1;
+
+            pull_type_t<R> block[pull_n_block_size] {};
+            while(written < n && !orange::empty(m.m_r)) {
+                size_t want = n - written < pull_n_block_size ? n - written : pull_n_block_size;
+                size_t got = orange::pull_n( m.m_r, block, want );
+                for(size_t i = 0; i<got; ++i) {
+                    auto mapped = m.m_f(block[i]);
+                    if(m.m_p(mapped))
+                        out[written++] = std::move(mapped);
+                }
+            }
+            m.skip_if_necessary();
+            return written;
+        }
 
-    // next, forward 'collect' and 'accumulate' via 'as_range()' if the lhs is not a range
-    template<typename R
-        , typename Tag
-        , typename Rnonref = std::remove_reference_t<R>
-        , SFINAE_ENABLE_IF_CHECK(   !is_range_v<Rnonref>
-                                 && (   std::is_same<Tag, collect_tag_t>{}
-                                     || std::is_same<Tag, discard_collect_tag_t>{}
-                                     || std::is_same<Tag, accumulate_tag_t>{}
-                                     || std::is_same<Tag, concat_tag_t>{}
-                                    ))
-        >
-    auto constexpr
-    operator| (R && r, Tag operation) {
-        return as_range(std::forward<R>(r)) | operation;
-    }
+        template<typename M> static constexpr auto
+        orange_slice      (M &m, size_t b, size_t e)
+        ->map_filter_range< std::decay_t<decltype(orange::slice( m.m_r, b, e ))>, F, P >
+        {   return { orange::slice( m.m_r, b, e ), m.m_f, m.m_p }; }
+        template<typename M> static constexpr auto
+        orange_slice_length (M &m)
+        ->decltype(orange::slice_length     ( m.m_r ))
+        {   return orange::slice_length     ( m.m_r ) ;}
+    };
 
-    //  |accumulate
-    template<typename R
-            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> )
+    // at most as many as 'R'
+    template<typename R, typename F, typename P>
+    struct static_size_of<map_filter_range<R,F,P>, orange_utils::void_t< decltype(static_size_of<R>::value) >>
+        : public static_size_is<static_size_of<R>::value, false> {};
+
+    template<typename R, typename F, typename Func
+            , SFINAE_ENABLE_IF_CHECK( !std::is_reference<decltype(impl::front_mapped_through(std::declval<R&>(), std::declval<F&>()))>{} )
             >
     auto constexpr
-    operator| (R r, accumulate_tag_t) {
-        static_assert(!std::is_reference<R>{},"");
-        static_assert( is_range_v<R> ,"");
+    operator| (forward_this_with_a_tag<mapping_range<R,F>,filter_tag_t> f, Func && func) {
+        return map_filter_range <   R
+                                ,   F
+                                ,   std::remove_reference_t<Func>
+                                > { std::move         (f.m_r.m_r)
+                                  , std::move         (f.m_r.m_f)
+                                  , std::forward<Func>(func)
+                                  };
+    }
 
-        using value_type = std::remove_reference_t<decltype(orange::pull(r))>;
+    /*  |take| n    |skip| n
+     *  ========    ========
+     *      '|take| n' stops after at most 'n' items. It keeps what the underlying
+     *  range has of 'size', 'slice', 'advance_n', 'front_at', 'begin' and 'end',
+     *  so a '|take|' over a vector can still be split up by 'orange_par.hh'
+     *  or zipped.
+     *      '|skip| n' drops the first 'n' items, and returns the range itself.
+     *  With 'advance_n' in the trait, as for a vector, that's O(1).
+     */
+    template<typename R>
+    struct take_range
+    {
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+        static_assert(!std::is_reference<R>{},"");
+        static_assert( is_range_v<R>, "");
+
+        R       m_r;
+        size_t  m_n; // how many more we may take
+
+        template<typename M> static constexpr bool
+        orange_empty      (M &m) { return m.m_n == 0 || orange::empty(m.m_r); }
+        template<typename M> static constexpr void
+        orange_advance    (M &m) { --m.m_n; orange::advance(m.m_r); }
+        template<typename M> static constexpr auto
+        orange_front      (M &m)
+        ->decltype(orange::front( m.m_r ))
+        {   return orange::front( m.m_r ); }
+
+        template<typename M> static constexpr auto
+        orange_size       (M &m)
+        ->decltype(void(orange::size( m.m_r )), size_t{})
+        {
+            size_t n = static_cast<size_t>(orange::size( m.m_r ));
+            return n < m.m_n ? n : m.m_n;
+        }
+        template<typename M> static constexpr size_hint_t
+        orange_size_hint  (M &m) {
+            size_hint_t h = orange::size_hint( m.m_r );
+            if( h.m_kind == enum_size_hint::unknown )
+                return { enum_size_hint::upper_bound, m.m_n };
+            if( h.m_n >= m.m_n )
+                return { h.m_kind == enum_size_hint::upper_bound ? enum_size_hint::upper_bound : enum_size_hint::exact, m.m_n };
+            return h;
+        }
+
+        template<typename M, typename U
+                , SFINAE_ENABLE_IF_CHECK( has_trait_pull_n<R&, U> )
+                > static constexpr size_t
+        orange_pull_n     (M &m, U *out, size_t n)
+        {
+            size_t got = orange::pull_n( m.m_r, out, n < m.m_n ? n : m.m_n );
+            m.m_n -= got;
+            return got;
+        }
+        template<typename M> static constexpr auto
+        orange_advance_n  (M &m, size_t n)
+        ->decltype(lookup_traits<R>::advance_n( m.m_r, n ))
+        {
+            size_t got = orange::advance_n( m.m_r, n < m.m_n ? n : m.m_n );
+            m.m_n -= got;
+            return got;
+        }
+        template<typename M> static constexpr auto
+        orange_front_at   (M &m, size_t i)
+        ->decltype(orange::front_at( m.m_r, i ))
+        {   return orange::front_at( m.m_r, i ); }
+
+        // A slice is within the first 'slice_length', so it needs no limit of its
+        // own. That's only the first 'm_n' items if 'R' has one position per item,
+        // which is when it has a 'size'. Under a '|filter|', the positions are
+        // those of the range below it, so there's no slicing.
+        template<typename M> static constexpr auto
+        orange_slice      (M &m, size_t b, size_t e)
+        ->decltype(void(orange::size( m.m_r )), orange::slice( m.m_r, b, e ))
+        {   return orange::slice( m.m_r, b, e ); }
+        template<typename M> static constexpr auto
+        orange_slice_length (M &m)
+        ->decltype(void(orange::size( m.m_r )), void(orange::slice( m.m_r, size_t(0), size_t(0) )), orange::slice_length( m.m_r ))
+        {
+            size_t n = orange::slice_length( m.m_r );
+            return n < m.m_n ? n : m.m_n;
+        }
+
+        template<typename M> static constexpr auto
+        orange_begin      (M &m)
+        ->decltype(void(orange_size(m)), lookup_traits<R>::begin( m.m_r ) + std::ptrdiff_t(0))
+        {   return orange::begin( m.m_r ); }
+        template<typename M> static constexpr auto
+        orange_end        (M &m)
+        ->decltype(void(orange_size(m)), lookup_traits<R>::begin( m.m_r ) + std::ptrdiff_t(0))
+        {   return orange::begin( m.m_r ) + static_cast<std::ptrdiff_t>(orange_size(m)); }
+    };
+
+    // at most as many as 'R'
+    template<typename R>
+    struct static_size_of<take_range<R>, orange_utils::void_t< decltype(static_size_of<R>::value) >>
+        : public static_size_is<static_size_of<R>::value, false> {};
+
+    template<typename R>
+    auto constexpr
+    operator| (forward_this_with_a_tag<R,take_tag_t> f, size_t n)
+    { return take_range<R>{ std::move(f.m_r), n }; }
+
+    template<typename R>
+    auto constexpr
+    operator| (forward_this_with_a_tag<R,skip_tag_t> f, size_t n)
+    -> R
+    {
+        orange::advance_n(f.m_r, n);
+        return std::move(f.m_r);
+    }
+
+    /*  |collect    |collect_with(allocator)    |collect_into(vector)
+     *  ========    ========================    =====================
+     *      '|collect' returns a new 'std::vector'. '|collect_with(a)' is the same
+     *  but the vector uses (a rebound copy of) the allocator 'a', for example an
+     *  'arena_allocator' (below). '|collect_into(v)' clears 'v', keeping its
+     *  capacity, then fills it, and returns a reference to it.
+     */
+    namespace impl {
+        // Blocks are pulled straight into the vector's own items, so they must
+        // be plain values of its 'value_type'. Not 'bool', as 'vector<bool>' is
+        // packed, and its items are proxies without '.data()'.
+        template<typename R, typename V> constexpr bool
+        can_collect_in_blocks   =   can_pull_in_blocks<R>
+                                &&  std::is_same<pull_type_t<R>, typename V::value_type>{}
+                                &&  std::is_trivially_copyable<pull_type_t<R>>{}
+                                && !std::is_same<pull_type_t<R>, bool>{};
+
+        template<typename R, typename V
+                , SFINAE_ENABLE_IF_CHECK( !can_collect_in_blocks<R, V> )
+                >
+        constexpr void
+        collect_after_clearing (R & r, V & res) {
+            res.clear();
+            orange:: reserve_for_size_hint(res, orange:: size_hint(r));
+
+            while(!orange::empty(r)) {
+                res.push_back( orange::pull(r) );
+            }
+        }
+
+        // in blocks, directly into the vector. We don't let a block
+        // go past the capacity that was reserved from the size hint.
+        template<typename R, typename V
+                , SFINAE_ENABLE_IF_CHECK( can_collect_in_blocks<R, V> )
+                >
+        constexpr void
+        collect_after_clearing (R & r, V & res) {
+            res.clear();
+            orange:: reserve_for_size_hint(res, orange:: size_hint(r));
+
+            while(!orange::empty(r)) {
+                size_t old_size = res.size();
+                size_t room     = res.capacity() - old_size;
+                size_t want     = room > 0 && room < pull_n_block_size ? room : pull_n_block_size;
+                res.resize(old_size + want);
+                size_t got = orange::pull_n(r, res.data() + old_size, want);
+                res.resize(old_size + got);
+            }
+        }
+    }
+
+    template<typename Alloc>
+    struct collect_with_tag_t { Alloc m_alloc; };
+    template<typename Alloc>
+    constexpr collect_with_tag_t<Alloc>
+    collect_with(Alloc alloc) { return { std::move(alloc) }; }
+
+    template<typename V>
+    struct collect_into_tag_t { V * m_v; };
+    template<typename T, typename Alloc>
+    constexpr collect_into_tag_t<std::vector<T, Alloc>>
+    collect_into(std::vector<T, Alloc> & v) { return { &v }; }
+
+    template<typename R
+            , typename Rnonref = std::remove_reference_t<R>
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<Rnonref> )
+            >
+    auto constexpr
+    operator| (R r, collect_tag_t) {
+        using value_type = pull_type_t<R>;
+        static_assert(!std::is_reference<value_type>{} ,"");
+        std:: vector<value_type> res;
+        impl:: collect_after_clearing(r, res);
+        return res;
+    }
+
+    template<typename R, typename Alloc
+            , typename Rnonref = std::remove_reference_t<R>
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<Rnonref> )
+            >
+    auto constexpr
+    operator| (R r, collect_with_tag_t<Alloc> with) {
+        using value_type = pull_type_t<R>;
+        static_assert(!std::is_reference<value_type>{} ,"");
+        using allocator_type = typename std:: allocator_traits<Alloc>:: template rebind_alloc<value_type>;
+        std:: vector<value_type, allocator_type> res{ allocator_type(with.m_alloc) };
+        impl:: collect_after_clearing(r, res);
+        return res;
+    }
+
+    template<typename R, typename V
+            , typename Rnonref = std::remove_reference_t<R>
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<Rnonref> )
+            >
+    auto constexpr
+    operator| (R r, collect_into_tag_t<V> into)
+    -> V &
+    {
+        impl:: collect_after_clearing(r, *into.m_v);
+        return *into.m_v;
+    }
+
+    /*  static_vector<T,N>
+     *  ==================
+     *      Up to 'N' items, stored inline. This is what '|collect_static'
+     *  returns when 'static_size_of' is only a bound. The unused items are
+     *  default constructed, so that it can be built in 'constexpr' in C++14.
+     */
+    template<typename T, size_t N>
+    class static_vector {
+        T       m_items[N == 0 ? 1 : N] {};
+        size_t  m_size = 0;
+
+    public:
+        using value_type = T;
+
+        constexpr static_vector() {}
+
+        constexpr size_t    size    ()  const   { return m_size; }
+        constexpr bool      empty   ()  const   { return m_size == 0; }
+        static constexpr
+        size_t              capacity()          { return N; }
+
+        constexpr T *       data    ()          { return m_items; }
+        constexpr T const * data    ()  const   { return m_items; }
+        constexpr T *       begin   ()          { return m_items; }
+        constexpr T const * begin   ()  const   { return m_items; }
+        constexpr T *       end     ()          { return m_items + m_size; }
+        constexpr T const * end     ()  const   { return m_items + m_size; }
+
+        constexpr T &       operator[] (size_t i)       { return m_items[i]; }
+        constexpr T const & operator[] (size_t i) const { return m_items[i]; }
+
+        constexpr void
+        push_back(T t)
+        {
+            assert(m_size < N);
+            m_items[m_size] = std::move(t);
+            ++m_size;
+        }
+    };
+
+    /*  |collect_static
+     *  ===============
+     *      For a range with a 'static_size_of', this collects into an
+     *  'std::array<T,N>' where the size is exact, or a 'static_vector<T,N>'
+     *  where it's a bound. There's no allocation, so it works in 'constexpr'.
+     *  An exact range must still have all of its items. If some have been
+     *  advanced over, it throws 'std::length_error' rather than read past the
+     *  end.
+     */
+    namespace impl {
+        template<typename R>
+        constexpr pull_type_t<R>
+        pull_for_collect_static(R & r) {
+            if(orange::empty(r))
+                throw std:: length_error("orange::collect_static: fewer items than the static size, as some were advanced over");
+            return orange::pull(r);
+        }
+
+        // the items of a braced list are evaluated in order
+        template<typename R, size_t ... Is>
+        constexpr auto
+        collect_static_exact(R & r, std::index_sequence<Is...>)
+        -> std:: array<pull_type_t<R>, sizeof...(Is)>
+        {   return {{ ((void)Is, impl:: pull_for_collect_static(r)) ... }}; }
+    }
+
+    // the static size is only probed here, not by every '|' as it's
+    // considered, as for '|accumulate' below
+    namespace impl {
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> && has_exact_static_size<R> )
+            >
+    auto constexpr
+    collect_static_range (R r) {
+        static_assert(!std::is_reference<pull_type_t<R>>{} ,"");
+        return impl:: collect_static_exact(r, std::make_index_sequence<static_size_of<R>::value>());
+    }
+
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> && has_static_size<R> && !has_exact_static_size<R> )
+            >
+    auto constexpr
+    collect_static_range (R r) {
+        using value_type = pull_type_t<R>;
+        static_assert(!std::is_reference<value_type>{} ,"");
+        static_vector<value_type, static_size_of<R>::value> res;
+        while(!orange::empty(r))
+            res.push_back(orange::pull(r));
+        return res;
+    }
+    }
+
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> )
+            >
+    auto constexpr
+    operator| (R r, collect_static_tag_t) {
+        static_assert(has_static_size<R> ,"|collect_static needs a range whose size is known from its type");
+        return impl:: collect_static_range(std::move(r));
+    }
+
+    /*  monotonic_arena, arena_allocator<T>
+     *  ===================================
+     *      For many small vectors that are all thrown away together, such as
+     *  those collected while handling one request. Each allocation just takes
+     *  the next bytes from the current block, and 'deallocate' does nothing.
+     *  'reset()' makes all the memory available again, keeping the largest
+     *  block so that the next round doesn't need to allocate it again.
+     *
+     *      monotonic_arena arena;
+     *      auto v = r |collect_with(arena_allocator<int>(arena));
+     */
+    class monotonic_arena {
+        struct block_header {
+            block_header *  m_previous;
+            size_t          m_size;     // of the memory following this header
+        };
+        static constexpr size_t header_size = (sizeof(block_header) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+        block_header *  m_block         = nullptr;  // the current (and largest) block
+        size_t          m_used          = 0;        // in the current block
+        size_t          m_next_size;
+
+        static char *
+        memory_of(block_header * b) { return reinterpret_cast<char*>(b) + header_size; }
+        static size_t
+        padding_for(char * p, size_t alignment) { return (alignment - reinterpret_cast<uintptr_t>(p) % alignment) % alignment; }
+
+        void
+        free_blocks(block_header * b) {
+            while(b) {
+                block_header * previous = b->m_previous;
+                ::operator delete(static_cast<void*>(b));
+                b = previous;
+            }
+        }
+
+      public:
+        explicit
+        monotonic_arena(size_t first_block_size = 4096) : m_next_size(first_block_size > 0 ? first_block_size : 1) {}
+        monotonic_arena(monotonic_arena const &) = delete;
+        monotonic_arena & operator= (monotonic_arena const &) = delete;
+        ~monotonic_arena() { free_blocks(m_block); }
+
+        void *
+        allocate(size_t bytes, size_t alignment) {
+            if(m_block) {
+                size_t start = m_used + padding_for(memory_of(m_block) + m_used, alignment);
+                if(start <= m_block->m_size && bytes <= m_block->m_size - start) {
+                    m_used = start + bytes;
+                    return memory_of(m_block) + start;
+                }
+            }
+            // a new block, at least twice the size of the last one
+            constexpr size_t largest = std::numeric_limits<size_t>::max() / 4;
+            if(bytes > largest || alignment > largest)
+                throw std::bad_alloc{};
+            size_t size = m_next_size > bytes + alignment ? m_next_size : bytes + alignment;
+            block_header * b = static_cast<block_header*>(::operator new(header_size + size));
+            b->m_previous   = m_block;
+            b->m_size       = size;
+            m_block         = b;
+            m_next_size     = size < largest ? 2 * size : size;
+            size_t start    = padding_for(memory_of(b), alignment);
+            m_used          = start + bytes;
+            return memory_of(b) + start;
+        }
+
+        void
+        reset() {
+            if(m_block) {
+                free_blocks(m_block->m_previous);
+                m_block->m_previous = nullptr;
+            }
+            m_used = 0;
+        }
+    };
+
+    template<typename T>
+    struct arena_allocator {
+        using value_type = T;
+        monotonic_arena * m_arena;
+
+        explicit
+        arena_allocator(monotonic_arena & arena) : m_arena(&arena) {}
+        template<typename U>
+        arena_allocator(arena_allocator<U> const & other) : m_arena(other.m_arena) {}
+
+        T *
+        allocate(size_t n) {
+            if(n > std::numeric_limits<size_t>::max() / sizeof(T))
+                throw std::bad_alloc{};
+            return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+        }
+        void
+        deallocate(T *, size_t) {}
+
+        template<typename U>
+        bool operator== (arena_allocator<U> const & other) const { return m_arena == other.m_arena; }
+        template<typename U>
+        bool operator!= (arena_allocator<U> const & other) const { return m_arena != other.m_arena; }
+    };
+
+
+    // |discard_collect|
+    template<typename R
+            , typename Rnonref = std::remove_reference_t<R>
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<Rnonref> )
+            >
+    void constexpr
+    operator| (R r, discard_collect_tag_t) {
+        static_assert( is_range_v<R> ,"");
+
+        while(!orange::empty(r))
+        { orange::pull(r); }
+
+    }
+
+
+    /*  |distinct       |count_by| key      |group_reduce(key, op)
+     *  =========       ==============      =====================
+     *      '|distinct' is lazy, and keeps the first of each equal item. The other
+     *  two run straight away, and return a 'std::vector' of '(key, result)' pairs,
+     *  in the order in which each key was first seen. '|count_by| key' counts the
+     *  items for each key. With '|group_reduce(key, op)', the result for a key is
+     *  its first item, then 'result = op(result, item)' for each of the others.
+     *
+     *      These all use 'flat_hash_table', an open-addressing hash table with
+     *  linear probing. The items (or the pairs) are together in one 'vector', and
+     *  the table itself is just the index of each one, so there's no allocation
+     *  per item. The table doubles as it grows. It isn't reserved from the size
+     *  of the range, as that's only a bound on the number of keys, and a range of
+     *  millions of items may have only a few.
+     */
+    namespace impl {
+        struct key_is_entry {
+            template<typename E> constexpr
+            E const &   operator() (E const & e) const { return e; }
+        };
+        struct key_is_first {
+            template<typename E> constexpr
+            auto const & operator() (E const & e) const { return e.first; }
+        };
+
+        template<typename Entry, typename KeyOf, typename Hash, typename Eq = std::equal_to<>>
+        struct flat_hash_table {
+            std:: vector<Entry>     m_entries;  // in the order they were first inserted
+            std:: vector<size_t>    m_slots;    // zero if empty, otherwise one more than the index into 'm_entries'
+            unsigned                m_shift = 64;   // the slot for a hash is the top bits of '(hash * multiplier)'
+            KeyOf                   m_key_of;
+            Hash                    m_hash;
+            Eq                      m_eq;
+
+            // Fibonacci hashing, so that the many 'std::hash's that are the identity
+            // don't put consecutive keys in consecutive slots
+            static constexpr uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+
+            template<typename K>
+            size_t
+            first_slot_for(K const & key) const
+            { return m_shift >= 64 ? 0 : static_cast<size_t>((static_cast<uint64_t>(m_hash(key)) * multiplier) >> m_shift); }
+
+            // no more than half full
+            void
+            reserve(size_t n) {
+                size_t wanted = 4;
+                unsigned shift = 62;
+                while(wanted < 2*n) {
+                    wanted *= 2;
+                    --shift;
+                }
+                if(wanted <= m_slots.size())
+                    return;
+                m_slots.assign(wanted, 0);
+                m_shift = shift;
+                for(size_t i = 0; i<m_entries.size(); ++i) {
+                    size_t slot = first_slot_for(m_key_of(m_entries[i]));
+                    while(m_slots[slot] != 0)
+                        slot = (slot + 1) & (m_slots.size() - 1);
+                    m_slots[slot] = i + 1;
+                }
+            }
+
+            // Returns the entry for 'key' and 'true' if it was made here, with
+            // 'args', or 'false' if there already was one.
+            template<typename K, typename ... Args>
+            std:: pair<Entry*, bool>
+            find_or_emplace(K const & key, Args && ... args) {
+                if(2*(m_entries.size() + 1) > m_slots.size())
+                    reserve(m_entries.size() + 1);
+                size_t slot = first_slot_for(key);
+                for(;;) {
+                    size_t index = m_slots[slot];
+                    if(index == 0)
+                        break;
+                    if(m_eq(m_key_of(m_entries[index - 1]), key))
+                        return { &m_entries[index - 1], false };
+                    slot = (slot + 1) & (m_slots.size() - 1);
+                }
+                m_entries.emplace_back(std::forward<Args>(args)...);
+                m_slots[slot] = m_entries.size();
+                return { &m_entries.back(), true };
+            }
+        };
+    }
+
+    struct distinct_tag_t{constexpr distinct_tag_t(){}};
+                                        constexpr            distinct_tag_t          distinct;  // no need for 'tagger_t', this directly runs
+    struct count_by_tag_t       {};     constexpr   tagger_t<count_by_tag_t     >   count_by;
+
+    template<typename Key, typename Op>
+    struct group_reduce_tag_t { Key m_key; Op m_op; };
+    template<typename Key, typename Op>
+    constexpr group_reduce_tag_t<std::decay_t<Key>, std::decay_t<Op>>
+    group_reduce(Key && key, Op && op) { return { std::forward<Key>(key), std::forward<Op>(op) }; }
+
+    template<typename R>
+    struct distinct_helper
+    {
+        static_assert(!std::is_reference<R>{} ,"");
+        using val_type = std::decay_t<decltype(orange::front(std::declval<R&>()))>;
+
+        R m_r;
+        impl:: flat_hash_table<val_type, impl:: key_is_entry, std::hash<val_type>> m_seen;
+
+        distinct_helper(R && r)
+        : m_r(std::move(r)), m_seen()
+        {
+            skip_if_necessary();
+        }
+
+        void
+        skip_if_necessary() {
+            while(!orange::empty(m_r)) {
+                decltype(auto) x = orange::front(m_r);
+                if(m_seen.find_or_emplace(x, x).second)
+                    return;
+                orange::advance(m_r);
+            }
+        }
+
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+
+        template<typename M> static bool
+        orange_empty      (M &m) { return orange::empty(m.m_r); }
+
+        template<typename M> static void
+        orange_advance    (M &m) { orange::advance(m.m_r); m.skip_if_necessary(); }
+
+        template<typename M> static auto
+        orange_front      (M &m)
+        ->decltype(orange::front(m.m_r))
+        {   return orange::front(m.m_r); }
+
+        template<typename M> static size_hint_t
+        orange_size_hint  (M &m) { return orange:: as_upper_bound( orange:: size_hint(m.m_r) );}
+    };
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> )
+            >
+    auto
+    operator| (R r, distinct_tag_t)
+    -> distinct_helper<R>
+    {
+        return {std::move(r)};
+    }
+
+    template<typename R, typename Key>
+    auto
+    operator| (forward_this_with_a_tag<R,count_by_tag_t> f, Key && key)
+    {
+        using key_type = std::decay_t<decltype(key(orange::front(f.m_r)))>;
+        impl:: flat_hash_table<std::pair<key_type, size_t>, impl:: key_is_first, std::hash<key_type>> counts;
+        for(; !orange::empty(f.m_r); orange::advance(f.m_r)) {
+            key_type k = key(orange::front(f.m_r));
+            ++ counts.find_or_emplace(k, k, size_t(0)).first->second;
+        }
+        return std::move(counts.m_entries);
+    }
+
+    template<typename R, typename Key, typename Op
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> )
+            >
+    auto
+    operator| (R r, group_reduce_tag_t<Key, Op> g)
+    {
+        using val_type = pull_type_t<R>;
+        using key_type = std::decay_t<decltype(g.m_key(std::declval<val_type&>()))>;
+        impl:: flat_hash_table<std::pair<key_type, val_type>, impl:: key_is_first, std::hash<key_type>> results;
+        while(!orange::empty(r)) {
+            val_type x = orange::pull(r);
+            key_type k = g.m_key(x);
+            auto found = results.find_or_emplace(k, k, x);
+            if(!found.second)
+                found.first->second = g.m_op(std::move(found.first->second), std::move(x));
+        }
+        return std::move(results.m_entries);
+    }
+
+    namespace impl {
+        // a variable, not a class, as it's checked against the rhs of every '|' whose lhs isn't a range
+        template<typename Tag>  constexpr bool is_tag_with_arguments                                = false;
+        template<typename A>    constexpr bool is_tag_with_arguments< collect_with_tag_t<A> >       = true;
+        template<typename V>    constexpr bool is_tag_with_arguments< collect_into_tag_t<V> >       = true;
+        template<typename K, typename O>
+                                constexpr bool is_tag_with_arguments< group_reduce_tag_t<K,O> >     = true;
+    }
+
+    // next, forward 'collect' and 'accumulate' via 'as_range()' if the lhs is not a range
+    template<typename R
+        , typename Tag
+        , typename Rnonref = std::remove_reference_t<R>
+        , SFINAE_ENABLE_IF_CHECK(   !is_range_v<Rnonref>
+                                 && (   std::is_same<Tag, collect_tag_t>{}
+                                     || std::is_same<Tag, collect_static_tag_t>{}
+                                     || std::is_same<Tag, min_max_tag_t>{}
+                                     || std::is_same<Tag, discard_collect_tag_t>{}
+                                     || std::is_same<Tag, accumulate_tag_t>{}
+                                     || std::is_same<Tag, accumulate_in_lanes_tag_t>{}
+                                     || std::is_same<Tag, concat_tag_t>{}
+                                     || std::is_same<Tag, merge_all_tag_t>{}
+                                     || std::is_same<Tag, distinct_tag_t>{}
+                                     || impl:: is_tag_with_arguments<Tag>
+                                    ))
+        >
+    auto constexpr
+    operator| (R && r, Tag operation) {
+        return as_range(std::forward<R>(r)) | operation;
+    }
+
+    /*  lanes_for<R>
+     *  ============
+     *      Some ranges can visit their remaining items by index, for example
+     *  when they are contiguous in memory, or are 'ints(l,u)', or are a
+     *  '|mapr|' or 'zip' of such ranges. For those, 'lanes_for<R>::view(r)'
+     *  gives a small object with
+     *
+     *      count()         - the number of positions
+     *      at(i)           - the item at position 'i'
+     *      selected(i)     - false if a '|filter|' drops position 'i'
+     *
+     *  which lets '|accumulate' add into several independent accumulators,
+     *  in a loop with a fixed count, which the compiler can vectorize.
+     *  'dense' is true if every position is selected. The functions are
+     *  called in the same order, and as often, as with the ordinary loop.
+     */
+    template<typename R, typename = void>
+    struct lanes_for {}; // no 'view'
+
+    namespace impl {
+        template<typename T>
+        struct pointer_lanes {
+            static constexpr bool dense = true;
+            T *     m_p;
+            size_t  m_n;
+            constexpr size_t    count()             const { return m_n; }
+            constexpr bool      selected(size_t)    const { return true; }
+            constexpr T &       at(size_t i)        const { return m_p[i]; }
+        };
+
+        template<typename T>
+        struct ints_lanes {
+            static constexpr bool dense = true;
+            T       m_b;
+            size_t  m_n;
+            constexpr size_t    count()             const { return m_n; }
+            constexpr bool      selected(size_t)    const { return true; }
+            constexpr T         at(size_t i)        const { return m_b + static_cast<T>(i); }
+        };
+
+        template<typename V, typename F>
+        struct mapped_lanes {
+            static constexpr bool dense = V::dense;
+            V       m_v;
+            F &     m_f;
+            constexpr size_t    count()             const { return m_v.count(); }
+            constexpr bool      selected(size_t i)  const { return m_v.selected(i); }
+            constexpr decltype(auto)
+                                at(size_t i)        const { return m_f(m_v.at(i)); }
+        };
+
+        // position 0 is the front of the '|filter|', which it has already
+        // tested, so we don't call the predicate on it again
+        template<typename V, typename F>
+        struct filtered_lanes {
+            static constexpr bool dense = false;
+            V       m_v;
+            F &     m_f;
+            constexpr size_t    count()             const { return m_v.count(); }
+            constexpr bool      selected(size_t i)  const { return m_v.selected(i) && (i == 0 || m_f(m_v.at(i))); }
+            constexpr decltype(auto)
+                                at(size_t i)        const { return m_v.at(i); }
+        };
+
+        // the type of each accumulator. Integers are added as unsigned, so that
+        // a lane can't overflow even where the in-order sum wouldn't have
+        template<typename T, bool = std::is_integral<T>{}>
+        struct lane_type            { using type = T; };
+        template<typename T>
+        struct lane_type<T, true>   { using type = std::make_unsigned_t<T>; };
+
+        constexpr size_t number_of_lanes = 8;
+
+        // The lanes are combined in a fixed tree, so the result doesn't
+        // depend on the compiler or the instruction set.
+        template<typename value_type, typename V>
+        constexpr value_type
+        sum_in_lanes(V const & v) {
+            using lane_t = typename lane_type<value_type>::type;
+            lane_t lanes[number_of_lanes] {};
+
+            size_t n = v.count();
+            size_t i = 0;
+            for(; i + number_of_lanes <= n; i += number_of_lanes) {
+                for(size_t j = 0; j<number_of_lanes; ++j)
+                    lanes[j] += v.selected(i+j) ? static_cast<lane_t>(v.at(i+j)) : lane_t(0);
+            }
+            for(size_t j = 0; j<number_of_lanes; ++j) // fewer than 'number_of_lanes' remain
+                if(i+j < n)
+                    lanes[j] += v.selected(i+j) ? static_cast<lane_t>(v.at(i+j)) : lane_t(0);
+
+            for(size_t width = number_of_lanes / 2; width > 0; width /= 2)
+                for(size_t j = 0; j<width; ++j)
+                    lanes[j] += lanes[j + width];
+            return static_cast<value_type>(lanes[0]);
+        }
+    }
+
+    template<typename R>
+    struct lanes_for<R, std::enable_if_t< has_trait_data<R&> && has_trait_size<R&> >> {
+        static constexpr auto
+        view(R & r)
+        { return impl:: pointer_lanes<std::remove_pointer_t<decltype(orange::data(r))>>{ orange::data(r), static_cast<size_t>(orange::size(r)) }; }
+    };
+
+    template<typename T>
+    struct lanes_for<pair_of_values<T>, std::enable_if_t< std::is_integral<T>{} >> {
+        static constexpr auto
+        view(pair_of_values<T> & r)
+        { return impl:: ints_lanes<T>{ r.m_begin, static_cast<size_t>(orange::size(r)) }; }
+    };
+
+    template<typename R, typename F>
+    struct lanes_for<mapping_range<R,F>, orange_utils::void_t< decltype(lanes_for<R>::view(std::declval<R&>())) >> {
+        static constexpr auto
+        view(mapping_range<R,F> & m)
+        {   return impl:: mapped_lanes<decltype(lanes_for<R>::view(m.m_r)), F>{ lanes_for<R>::view(m.m_r), m.m_f }; }
+    };
+
+    template<typename R, typename F>
+    struct lanes_for<filter_range<R,F>, orange_utils::void_t< decltype(lanes_for<R>::view(std::declval<R&>())) >> {
+        static constexpr auto
+        view(filter_range<R,F> & m)
+        {   return impl:: filtered_lanes<decltype(lanes_for<R>::view(m.m_r)), F>{ lanes_for<R>::view(m.m_r), m.m_f }; }
+    };
+
+    /*  can_accumulate_in_lanes
+     *  =======================
+     *      '|accumulate' uses the lanes by default only for integers, where the
+     *  order of addition makes no difference. For floating point, the order
+     *  matters, and '|accumulate' keeps the original left-to-right order. Use
+     *  '|accumulate_in_lanes' to allow the lanes; it's still deterministic,
+     *  but may differ slightly from '|accumulate'.
+     */
+    auto checker_for__has_lanes     = [](auto&&r)->decltype(void( lanes_for<std::remove_reference_t<decltype(r)>>::view(r) )){};
+
+    template<typename R> constexpr bool
+    has_lanes   = orange_utils:: is_invokable_v<decltype(checker_for__has_lanes), R&>;
+
+    auto checker_for__can_accumulate_in_lanes = [](auto&&r)->std::enable_if_t<
+                    std::is_arithmetic<std::remove_reference_t<decltype(orange::pull(r))>>{}
+                && !std::is_same<bool, std::remove_cv_t<std::remove_reference_t<decltype(orange::pull(r))>>>{}
+                && has_lanes<decltype(r)>
+            >{};
+    auto checker_for__can_accumulate_integers_in_lanes = [](auto&&r)->std::enable_if_t<
+                    std::is_integral<std::remove_reference_t<decltype(orange::pull(r))>>{}
+            >{};
+
+    template<typename R> constexpr bool
+    can_accumulate_in_lanes             = orange_utils:: is_invokable_v<decltype(checker_for__can_accumulate_in_lanes), R&>;
+    template<typename R> constexpr bool
+    can_accumulate_integers_in_lanes    =  can_accumulate_in_lanes<R>
+                                        && orange_utils:: is_invokable_v<decltype(checker_for__can_accumulate_integers_in_lanes), R&>;
+
+    /*  |accumulate
+     *      Every 'x | y' in a pipeline considers every 'operator|' whose tag isn't
+     *  deduced, and checks its conditions against the type of 'x'. So that those
+     *  are just 'is_range_v', the choice between the ways of accumulating is made
+     *  here in 'impl', only by the '|accumulate' that runs.
+     */
+    namespace impl {
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> && !can_pull_in_blocks<R> && !can_accumulate_integers_in_lanes<R> && !can_loop_statically<R> )
+            >
+    auto constexpr
+    accumulate_range (R r) {
+        static_assert(!std::is_reference<R>{},"");
+        static_assert( is_range_v<R> ,"");
+
+        using value_type = std::remove_reference_t<decltype(orange::pull(r))>;
+        value_type total = 0;
+
+        while(!orange::empty(r)) {
+            total += orange:: front(r);
+            orange:: advance(r);
+        }
+
+        return total;
+    }
+
+    //  |accumulate, in blocks. Same order of addition as above.
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> && can_pull_in_blocks<R> && !can_accumulate_integers_in_lanes<R> && !can_loop_statically<R> )
+            >
+    auto constexpr
+    accumulate_range (R r) {
+        static_assert(!std::is_reference<R>{},"");
+        static_assert( is_range_v<R> ,"");
+
+        using value_type = pull_type_t<R>;
+        value_type total = 0;
+        value_type block[pull_n_block_size] {};
+
+        for(;;) {
+            size_t got = orange::pull_n(r, block, pull_n_block_size);
+            for(size_t i = 0; i<got; ++i)
+                total += block[i];
+            if(got < pull_n_block_size)
+                break;
+        }
+
+        return total;
+    }
+
+    //  |accumulate, with a constant count, so the compiler can unroll it. Same
+    //  order of addition as above.
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> && can_loop_statically<R> && !can_accumulate_integers_in_lanes<R> )
+            >
+    auto constexpr
+    accumulate_range (R r) {
+        using value_type = std::remove_reference_t<decltype(orange::pull(r))>;
         value_type total = 0;
 
-        while(!orange::empty(r)) {
-            total += orange:: front(r);
-            orange:: advance(r);
+        if(orange::size(r) != static_size_of<R>::value) { // some have been advanced over already
+            while(!orange::empty(r))
+                total += orange:: pull(r);
+            return total;
         }
+        for(size_t i = 0; i<static_size_of<R>::value; ++i)
+            total += orange:: front_at(r, i);
 
         return total;
     }
 
+    //  |accumulate, with several accumulators. Only for integers.
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> && can_accumulate_integers_in_lanes<R> )
+            >
+    auto constexpr
+    accumulate_range (R r) {
+        using value_type = std::remove_reference_t<decltype(orange::pull(r))>;
+        return impl:: sum_in_lanes<value_type>( lanes_for<R>::view(r) );
+    }
+    }
+
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> )
+            >
+    auto constexpr
+    operator| (R r, accumulate_tag_t)
+    { return impl:: accumulate_range(std::move(r)); }
+
+    //  |accumulate_in_lanes, which also allows floating point
+    namespace impl {
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> && can_accumulate_in_lanes<R> )
+            >
+    auto constexpr
+    accumulate_range_in_lanes (R r) {
+        using value_type = std::remove_reference_t<decltype(orange::pull(r))>;
+        return impl:: sum_in_lanes<value_type>( lanes_for<R>::view(r) );
+    }
+
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> && !can_accumulate_in_lanes<R> )
+            >
+    auto constexpr
+    accumulate_range_in_lanes (R r) {
+        return std::move(r) | accumulate;
+    }
+    }
+
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> )
+            >
+    auto constexpr
+    operator| (R r, accumulate_in_lanes_tag_t)
+    { return impl:: accumulate_range_in_lanes(std::move(r)); }
+
+    /*  |find_if| p     |any_of| p      |all_of| p      |min_max
+     *  ==========      ==========      ==========      ========
+     *      These stop pulling as soon as the answer is known. '|find_if| p'
+     *  is the first item for which 'p' is true, in an 'optional_value' that's
+     *  empty if there's none. '|min_max' is the smallest and the largest, in
+     *  one pass, as a 'min_max_t' in an 'optional_value', empty for an empty
+     *  range.
+     *
+     *      Over contiguous arithmetic values (with 'data' and 'size'), the
+     *  predicate is applied to a block of 'find_block_size' items at a time
+     *  with no branch, which the compiler can vectorize, and only then is
+     *  the block searched. So 'p' may be called for a few items after the
+     *  first match. '|min_max' keeps several minimums and maximums there,
+     *  as '|accumulate' keeps several totals.
+     */
+    template<typename T>
+    struct min_max_t {
+        T m_min;
+        T m_max;
+    };
+
+    constexpr size_t find_block_size = 32;
+
+    namespace impl {
+        template<typename R>
+        constexpr auto
+        is_contiguous_arithmetic_impl(orange_utils:: priority_tag<1>)
+        ->decltype(void(orange::data(std::declval<R&>())), void(orange::size(std::declval<R&>())), bool())
+        {   return std::is_arithmetic< std::remove_cv_t<std::remove_pointer_t<decltype(orange::data(std::declval<R&>()))>> >{}; }
+        template<typename R>
+        constexpr bool
+        is_contiguous_arithmetic_impl(orange_utils:: priority_tag<0>) { return false; }
+
+        template<typename R> constexpr bool
+        is_contiguous_arithmetic = is_contiguous_arithmetic_impl<R>(orange_utils:: priority_tag<9>{});
+
+        // the position of the first match, or 'n'
+        template<typename T, typename P>
+        constexpr size_t
+        find_in_contiguous(T * d, size_t n, P & p)
+        {
+            size_t i = 0;
+            for(; i + find_block_size <= n; i += find_block_size) {
+                unsigned any = 0; // not a 'bool', which gcc doesn't vectorize
+                for(size_t j = 0; j<find_block_size; ++j)
+                    any |= static_cast<unsigned>(static_cast<bool>(p(d[i+j])));
+                if(any)
+                    break;
+            }
+            for(; i<n; ++i)
+                if(p(d[i]))
+                    return i;
+            return n;
+        }
+
+        template<typename R, typename P
+                , SFINAE_ENABLE_IF_CHECK( !is_contiguous_arithmetic<R> )
+                >
+        constexpr bool
+        any_match(R & r, P & p)
+        {
+            for(; !orange::empty(r); orange::advance(r))
+                if(p(orange::front(r)))
+                    return true;
+            return false;
+        }
+
+        template<typename R, typename P
+                , SFINAE_ENABLE_IF_CHECK( is_contiguous_arithmetic<R> )
+                >
+        constexpr bool
+        any_match(R & r, P & p)
+        {
+            size_t n = static_cast<size_t>(orange::size(r));
+            return find_in_contiguous(orange::data(r), n, p) < n;
+        }
+
+        template<typename P>
+        struct negated_t {
+            P & m_p;
+            template<typename X>
+            constexpr bool
+            operator() (X && x) const { return !m_p(std::forward<X>(x)); }
+        };
+    }
+
+    template<typename R, typename P
+            , SFINAE_ENABLE_IF_CHECK( !impl::is_contiguous_arithmetic<R> )
+            >
+    constexpr auto
+    operator| (forward_this_with_a_tag<R,find_if_tag_t> f, P && p)
+    {
+        orange_utils:: optional_value<std::decay_t<decltype(orange::front(f.m_r))>> found;
+        for(; !orange::empty(f.m_r); orange::advance(f.m_r)) {
+            decltype(auto) x = orange::front(f.m_r);
+            if(p(x)) {
+                found.emplace(x);
+                break;
+            }
+        }
+        return found;
+    }
+
+    template<typename R, typename P
+            , SFINAE_ENABLE_IF_CHECK( impl::is_contiguous_arithmetic<R> )
+            >
+    constexpr auto
+    operator| (forward_this_with_a_tag<R,find_if_tag_t> f, P && p)
+    {
+        orange_utils:: optional_value<std::decay_t<decltype(orange::front(f.m_r))>> found;
+        auto d      = orange::data(f.m_r);
+        size_t n    = static_cast<size_t>(orange::size(f.m_r));
+        size_t i    = impl:: find_in_contiguous(d, n, p);
+        if(i < n)
+            found.emplace(d[i]);
+        return found;
+    }
+
+    template<typename R, typename P>
+    constexpr bool
+    operator| (forward_this_with_a_tag<R,any_of_tag_t> f, P && p)
+    {   return impl:: any_match(f.m_r, p); }
+
+    template<typename R, typename P>
+    constexpr bool
+    operator| (forward_this_with_a_tag<R,all_of_tag_t> f, P && p)
+    {
+        impl:: negated_t<std::remove_reference_t<P>> not_p {p};
+        return !impl:: any_match(f.m_r, not_p);
+    }
+
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> && !impl::is_contiguous_arithmetic<R> )
+            >
+    constexpr auto
+    operator| (R r, min_max_tag_t)
+    {
+        using value_type = std::decay_t<decltype(orange::front(r))>;
+        orange_utils:: optional_value<min_max_t<value_type>> res;
+        if(orange::empty(r))
+            return res;
+        value_type lo = orange::front(r);
+        value_type hi = lo;
+        for(orange::advance(r); !orange::empty(r); orange::advance(r)) {
+            decltype(auto) x = orange::front(r);
+            if(x  < lo) lo = x;
+            if(hi < x ) hi = x;
+        }
+        res.emplace(min_max_t<value_type>{ lo, hi });
+        return res;
+    }
+
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> && impl::is_contiguous_arithmetic<R> )
+            >
+    constexpr auto
+    operator| (R r, min_max_tag_t)
+    {
+        using value_type = std::decay_t<decltype(orange::front(r))>;
+        constexpr size_t number_of_lanes = 8;
+        orange_utils:: optional_value<min_max_t<value_type>> res;
+        auto d      = orange::data(r);
+        size_t n    = static_cast<size_t>(orange::size(r));
+        if(n == 0)
+            return res;
+
+        value_type lo[number_of_lanes] {};
+        value_type hi[number_of_lanes] {};
+        for(size_t j = 0; j<number_of_lanes; ++j)
+            lo[j] = hi[j] = d[0];
+        size_t i = 1;
+        for(; i + number_of_lanes <= n; i += number_of_lanes)
+            for(size_t j = 0; j<number_of_lanes; ++j) {
+                value_type x = d[i+j];
+                lo[j] = x     < lo[j] ? x : lo[j];
+                hi[j] = hi[j] < x     ? x : hi[j];
+            }
+        for(; i<n; ++i) {
+            lo[0] = d[i]  < lo[0] ? d[i] : lo[0];
+            hi[0] = hi[0] < d[i]  ? d[i] : hi[0];
+        }
+        for(size_t j = 1; j<number_of_lanes; ++j) {
+            lo[0] = lo[j] < lo[0] ? lo[j] : lo[0];
+            hi[0] = hi[0] < hi[j] ? hi[j] : hi[0];
+        }
+        res.emplace(min_max_t<value_type>{ lo[0], hi[0] });
+        return res;
+    }
+
+    /*  |scan| op
+     *  =========
+     *      The running totals: the first item, then 'op(first, second)', then
+     *  'op' of that and the third, and so on. Each total is computed when the
+     *  range advances to it.
+     */
+    template<typename R, typename Op>
+    struct scan_range
+    {
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+        static_assert(!std::is_reference<R>{},"");
+        static_assert(!std::is_reference<Op>{},"");
+        static_assert( is_range_v<R>, "");
+
+        using value_type = std::decay_t<decltype(orange::front(std::declval<R&>()))>;
+
+        R   m_r;
+        Op  m_op;
+        orange_utils:: optional_value<value_type> m_total; // the total up to, and including, the front of 'm_r'
+
+        template<typename RR, typename OO>
+        constexpr
+        scan_range(RR && r, OO && op)
+        : m_r(std::forward<RR>(r)) , m_op(std::forward<OO>(op)) , m_total()
+        {
+            if(!orange::empty(m_r))
+                m_total.emplace(orange::front(m_r));
+        }
+
+        template<typename M> static constexpr bool
+        orange_empty      (M &m) { return !m.m_total.has_value(); }
+        template<typename M> static constexpr auto
+        orange_front      (M &m)
+        -> value_type const &
+        { return *m.m_total; }
+        template<typename M> static constexpr void
+        orange_advance    (M &m) {
+            orange::advance(m.m_r);
+            if(orange::empty(m.m_r)) {
+                m.m_total.reset();
+                return;
+            }
+            value_type next = m.m_op(std::move(*m.m_total), orange::front(m.m_r));
+            m.m_total.emplace(std::move(next));
+        }
+        template<typename M> static constexpr auto
+        orange_size       (M &m)
+        ->decltype(orange::size( m.m_r ))
+        {   return orange::size( m.m_r ); }
+        template<typename M> static constexpr size_hint_t
+        orange_size_hint  (M &m) { return orange::size_hint( m.m_r ); }
+    };
+
+    template<typename R, typename Op>
+    struct static_size_of<scan_range<R,Op>> : public static_size_of<R> {};
+
+    template<typename R, typename Op>
+    auto constexpr
+    operator| (forward_this_with_a_tag<R,scan_tag_t> f, Op && op)
+    { return scan_range<R, std::decay_t<Op>>{ std::move(f.m_r), std::forward<Op>(op) }; }
+
+    /*  accumulator<T, Op>
+     *  ==================
+     *      A total that outlives one '|accumulate'. 'feed(r)' folds the items
+     *  of 'r' into it, and can be called again later with more. 'merge(other)'
+     *  folds in the total of another accumulator, for example from another
+     *  thread or shard; 'op' should be associative for that. Each total starts
+     *  from its own 'init', so for 'merge' the 'init' must be the identity of
+     *  'op' (such as '0' for '+'). Two accumulators made with
+     *  'make_accumulator(100)' would count the 100 twice once merged, so give
+     *  the 100 to only one of them. 'count()' is how many items have been fed
+     *  in, so an append-only log is caught up with
+     *
+     *      acc.feed( log |skip| acc.count() );
+     *
+     *  'state()' is a plain 'accumulator_state', to be stored however suits,
+     *  and an accumulator can be constructed from one to carry on later.
+     */
+    template<typename T>
+    struct accumulator_state {
+        T       m_total;
+        size_t  m_count;
+    };
+
+    template<typename T, typename Op = std::plus<>>
+    class accumulator {
+        accumulator_state<T>    m_state;
+        Op                      m_op;
+
+    public:
+        constexpr explicit
+        accumulator (T init = T{}, Op op = Op{})
+        : m_state{ std::move(init), 0 } , m_op(std::move(op)) {}
+
+        constexpr explicit
+        accumulator (accumulator_state<T> state, Op op = Op{})
+        : m_state(std::move(state)) , m_op(std::move(op)) {}
+
+        template<typename R>
+        constexpr accumulator &
+        feed        (R && r) {
+            auto rr = as_range(std::forward<R>(r));
+            for(; !orange::empty(rr); orange::advance(rr)) {
+                m_state.m_total = m_op(std::move(m_state.m_total), orange::front(rr));
+                ++m_state.m_count;
+            }
+            return *this;
+        }
+
+        // 'other' must have started from the identity of 'op'; see above
+        constexpr accumulator &
+        merge       (accumulator const & other) {
+            m_state.m_total = m_op(std::move(m_state.m_total), other.m_state.m_total);
+            m_state.m_count += other.m_state.m_count;
+            return *this;
+        }
+
+        constexpr T const &                     total() const { return m_state.m_total; }
+        constexpr size_t                        count() const { return m_state.m_count; }
+        constexpr accumulator_state<T> const &  state() const { return m_state; }
+    };
+
+    template<typename T, typename Op = std::plus<>>
+    constexpr accumulator<T, Op>
+    make_accumulator(T init, Op op = Op{})
+    { return accumulator<T, Op>{ std::move(init), std::move(op) }; }
+
     /*  |concat
      *      Flatten a range-of-ranges into a range
      */
@@ -1129,7 +3798,7 @@ namespace orange {
 
     /*  |memoize
      *      first time 'front' is called, store the value and return
-     *      the copy later
+     *      the copy later. 'pull' moves it out
      */
     template<typename R>
     struct memoize_helper
@@ -1138,58 +3807,457 @@ namespace orange {
         using val_type = std::remove_reference_t<decltype(orange::front(std::declval<R&>()))>;
         static_assert(!std::is_reference<val_type>{} ,"");
 
-        R m_r;
-        std::unique_ptr<val_type> m_current;
+        R m_r;
+        orange_utils:: optional_value<val_type> m_current;
+
+        constexpr
+        memoize_helper(R && r)
+        : m_r(std::move(r))
+        , m_current()
+        {
+            if(!orange::empty(m_r)) {
+                m_current.emplace(orange::front(m_r));
+                orange::advance(m_r);
+            }
+        }
+
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+
+
+        template<typename M> static constexpr bool
+        orange_empty      (M &m)
+        {
+            return !m.m_current.has_value();
+        }
+
+        template<typename M> static constexpr void
+        orange_advance    (M &m)
+        {
+            m.m_current.reset();
+            if(!orange::empty(m.m_r)) {
+                m.m_current.emplace(orange::front(m.m_r));
+                orange::advance(m.m_r);
+            }
+        }
+
+        template<typename M> static constexpr auto
+        orange_front      (M &m)
+        -> val_type&
+        { return *m.m_current; }
+
+        // the stored value won't be read again, so it's moved out
+        template<typename M> static constexpr auto
+        orange_pull       (M &m)
+        -> val_type
+        {
+            val_type v = std::move(*m.m_current);
+            orange_advance(m);
+            return v;
+        }
+    };
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> )
+            >
+    auto constexpr
+    operator| (R r, memoize_tag_t)
+    -> memoize_helper<R>
+    {
+        static_assert( is_range_v<R> ,"");
+
+        return {std::move(r)};
+    }
+
+    /*  |memoize_n<K>
+     *      a lookahead of up to 'K' items. Each 'front' of the underlying
+     *      range is called once, and stored in a ring buffer until this
+     *      range is advanced past it.
+     */
+    template<typename R, size_t K>
+    struct memoize_n_helper
+    {
+        static_assert(!std::is_reference<R>{} ,"");
+        static_assert(K > 0 ,"");
+        using val_type = std::remove_reference_t<decltype(orange::front(std::declval<R&>()))>;
+        static_assert(!std::is_reference<val_type>{} ,"");
+
+        R m_r;
+        orange_utils:: optional_value<val_type> m_ring[K];
+        size_t m_head;  // the front is in 'm_ring[m_head]'
+        size_t m_count; // how many are stored, starting at 'm_head'
+
+        constexpr
+        memoize_n_helper(R && r)
+        : m_r(std::move(r))
+        , m_ring{}
+        , m_head(0)
+        , m_count(0)
+        { fill(); }
+
+        constexpr void
+        fill() {
+            while(m_count < K && !orange::empty(m_r)) {
+                m_ring[(m_head + m_count) % K].emplace(orange::front(m_r));
+                orange::advance(m_r);
+                ++m_count;
+            }
+        }
+
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+
+        template<typename M> static constexpr bool
+        orange_empty      (M &m)
+        { return m.m_count == 0; }
+
+        template<typename M> static constexpr void
+        orange_advance    (M &m)
+        {
+            m.m_ring[m.m_head].reset();
+            m.m_head = (m.m_head + 1) % K;
+            --m.m_count;
+            m.fill();
+        }
+
+        template<typename M> static constexpr auto
+        orange_front      (M &m)
+        -> val_type&
+        { return *m.m_ring[m.m_head]; }
+
+        template<typename M> static constexpr auto
+        orange_pull       (M &m)
+        -> val_type
+        {
+            val_type v = std::move(*m.m_ring[m.m_head]);
+            orange_advance(m);
+            return v;
+        }
+    };
+    template<typename R, size_t K
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> )
+            >
+    auto constexpr
+    operator| (R r, memoize_n_tag_t<K>)
+    -> memoize_n_helper<R, K>
+    {
+        static_assert( is_range_v<R> ,"");
+
+        return {std::move(r)};
+    }
+
+    /*  |chunk| n     |group_by| key
+     *  ===========   ==============
+     *      A range of batches. '|chunk| n' has 'n' items in each batch, except
+     *  perhaps the last. '|group_by| key' has a batch for each run of items with
+     *  equal 'key(item)'.
+     *      Where the underlying range can be sliced, with one position per item
+     *  (i.e. it has 'size'), each batch is a slice of it and nothing is copied.
+     *  Otherwise, each batch is pulled into a buffer that's reused for the next
+     *  batch; 'front' is then a 'pair_of_iterators' into that buffer, which is
+     *  only valid until 'advance'.
+     *      'front' is an lvalue, so '|concat' can flatten the batches again.
+     *  '|chunk' can itself be sliced, by batch, for the parallel modes.
+     */
+    namespace impl {
+        struct chunk_of_n {
+            size_t m_n;     // at least one, so that every batch makes progress
+
+            template<typename R> constexpr size_t
+            end_of_batch        (R &, size_t b, size_t length)  const
+            { return length - b < m_n ? length : b + m_n; }
+
+            constexpr size_t
+            number_of_batches   (size_t b, size_t length)       const
+            { return (length - b + m_n - 1) / m_n; }
+
+            constexpr size_t
+            start_of_batch      (size_t b, size_t i, size_t length) const
+            { return length - b < i * m_n ? length : b + i * m_n; }
+
+            // returns the size of the next batch. The buffer is empty here
+            template<typename R, typename Buffer, SFINAE_ENABLE_IF_CHECK( can_pull_in_blocks<R> )>
+            size_t
+            fill_batch          (R & r, Buffer & buffer)
+            {
+                buffer.resize(m_n);
+                buffer.resize(orange::pull_n(r, buffer.data(), m_n));
+                return buffer.size();
+            }
+            template<typename R, typename Buffer, SFINAE_ENABLE_IF_CHECK( !can_pull_in_blocks<R> )>
+            size_t
+            fill_batch          (R & r, Buffer & buffer)
+            {
+                while(buffer.size() < m_n && !orange::empty(r))
+                    buffer.push_back(orange::pull(r));
+                return buffer.size();
+            }
+        };
+
+        template<typename K>
+        struct runs_of_equal_keys {
+            K m_key;
+
+            template<typename R> constexpr size_t
+            end_of_batch        (R & r, size_t b, size_t length)
+            {
+                if(b == length)
+                    return length;
+                auto rest = orange::slice(r, b, length);
+                auto const key_of_batch = m_key(orange::front(rest));
+                orange::advance(rest);
+                size_t e = b + 1;
+                while(!orange::empty(rest) && m_key(orange::front(rest)) == key_of_batch) {
+                    orange::advance(rest);
+                    ++e;
+                }
+                return e;
+            }
+
+            // The buffer may already hold the first item of this batch, pulled
+            // while looking for the end of the previous batch. In the same way, we
+            // leave the first item of the next batch after this one in the buffer.
+            template<typename R, typename Buffer>
+            size_t
+            fill_batch          (R & r, Buffer & buffer)
+            {
+                if(buffer.empty() && !orange::empty(r))
+                    buffer.push_back(orange::pull(r));
+                if(buffer.empty())
+                    return 0;
+                auto const key_of_batch = m_key(buffer.front());
+                while(!orange::empty(r)) {
+                    buffer.push_back(orange::pull(r));
+                    if(!(m_key(buffer.back()) == key_of_batch))
+                        return buffer.size() - 1;
+                }
+                return buffer.size();
+            }
+        };
+    }
+
+    template<typename R, typename Policy>
+    struct batches_range
+    {
+        static_assert(!std::is_reference<R>{} ,"");
+        using slice_type = std::decay_t<decltype(orange::slice(std::declval<R&>(), size_t(0), size_t(0)))>;
+
+        R       m_r;
+        Policy  m_policy;
+        size_t  m_length;   // 'slice_length' of 'm_r'
+        size_t  m_b;        // the current batch is [m_b, m_e)
+        size_t  m_e;
+        orange_utils:: optional_value<slice_type> m_current;
+
+        constexpr
+        batches_range(R && r, Policy policy)
+        : m_r(std::move(r)), m_policy(std::move(policy)), m_length(orange::slice_length(m_r)), m_b(0), m_e(0), m_current()
+        { start_batch(); }
 
+        // 'm_current' might point into 'm_r', so it's sliced again from our
+        // own 'm_r', after whatever '|concat' has already consumed from it
         constexpr
-        memoize_helper(R && r)
-        : m_r(std::move(r))
-        {
-            if(!orange::empty(m_r)) {
-                m_current = std::make_unique<val_type>(orange::front(m_r));
-                orange::advance(m_r);
-            }
+        batches_range(batches_range const & other)
+        : m_r(other.m_r), m_policy(other.m_policy), m_length(other.m_length), m_b(other.m_b), m_e(other.m_e), m_current()
+        { resume_batch(other); }
+        constexpr
+        batches_range(batches_range && other)
+        : m_r(std::move(other.m_r)), m_policy(std::move(other.m_policy)), m_length(other.m_length), m_b(other.m_b), m_e(other.m_e), m_current()
+        { resume_batch(other); }
+
+        constexpr void
+        start_batch() {
+            m_e = m_policy.end_of_batch(m_r, m_b, m_length);
+            m_current.emplace(orange::slice(m_r, m_b, m_e));
+        }
+        constexpr void
+        resume_batch(batches_range const & other) {
+            if(other.m_current.has_value())
+                m_current.emplace(orange::slice(m_r, m_e - static_cast<size_t>(orange::size(*other.m_current)), m_e));
         }
 
         using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
 
-
         template<typename M> static constexpr bool
-        orange_empty      (M &m)
-        {
-            //std::cout << m.m_current.get() << '\n';
-            return !m.m_current;
-        }
+        orange_empty      (M &m) { return m.m_b == m.m_e; }
 
         template<typename M> static constexpr void
-        orange_advance    (M &m)
-        {
-            m.m_current.reset();
-            if(!orange::empty(m.m_r)) {
-                m.m_current = std::make_unique<val_type>(orange::front(m.m_r));
-                orange::advance(m.m_r);
-            }
-        }
+        orange_advance    (M &m) { m.m_b = m.m_e; m.start_batch(); }
 
         template<typename M> static constexpr auto
         orange_front      (M &m)
-        -> val_type&
+        -> slice_type &
         { return *m.m_current; }
+
+        template<typename M> static constexpr auto
+        orange_size       (M &m)
+        ->decltype(m.m_policy.number_of_batches(m.m_b, m.m_length))
+        {   return m.m_policy.number_of_batches(m.m_b, m.m_length); }
+
+        // the positions are the batches
+        template<typename M> static constexpr auto
+        orange_slice      (M &m, size_t b, size_t e)
+        ->std::decay_t<decltype( void(m.m_policy.start_of_batch(m.m_b, b, m.m_length)), std::declval<batches_range<slice_type, Policy>>() )>
+        {
+            size_t sb = m.m_policy.start_of_batch(m.m_b, b, m.m_length);
+            size_t se = m.m_policy.start_of_batch(m.m_b, e, m.m_length);
+            return { orange::slice(m.m_r, sb, se), m.m_policy };
+        }
     };
-    template<typename R
-            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> )
-            >
-    auto constexpr
-    operator| (R r, memoize_tag_t)
-    -> memoize_helper<R>
+
+    namespace impl {
+        /*  bool_batch_buffer
+         *      The buffer of a 'buffered_batches_range' of 'bool's. Each batch is
+         *  a pair of 'bool*', but 'std::vector<bool>' is packed, so this is a
+         *  real array of them, with the parts of 'vector' that are used here.
+         */
+        class bool_batch_buffer {
+            std:: unique_ptr<bool[]>    m_items;
+            size_t                      m_size      = 0;
+            size_t                      m_capacity  = 0;
+
+            void
+            reserve(size_t n) {
+                if(n <= m_capacity)
+                    return;
+                size_t capacity = m_capacity == 0 ? 16 : 2 * m_capacity;
+                if(capacity < n)
+                    capacity = n;
+                std:: unique_ptr<bool[]> items(new bool[capacity]);
+                std:: copy_n(m_items.get(), m_size, items.get());
+                m_items     = std::move(items);
+                m_capacity  = capacity;
+            }
+
+        public:
+            bool_batch_buffer() = default;
+            bool_batch_buffer(bool_batch_buffer const & other)
+            { reserve(other.m_size); std:: copy_n(other.m_items.get(), other.m_size, m_items.get()); m_size = other.m_size; }
+            bool_batch_buffer(bool_batch_buffer && other) noexcept
+            { swap(other); }
+            bool_batch_buffer & operator= (bool_batch_buffer other) noexcept
+            { swap(other); return *this; }
+
+            void
+            swap(bool_batch_buffer & other) noexcept {
+                std:: swap(m_items    , other.m_items);
+                std:: swap(m_size     , other.m_size);
+                std:: swap(m_capacity , other.m_capacity);
+            }
+
+            size_t          size    ()  const   { return m_size; }
+            bool            empty   ()  const   { return m_size == 0; }
+            bool *          data    ()          { return m_items.get(); }
+            bool const *    data    ()  const   { return m_items.get(); }
+            bool *          begin   ()          { return m_items.get(); }
+            bool const &    front   ()  const   { return m_items[0]; }
+            bool const &    back    ()  const   { return m_items[m_size - 1]; }
+
+            void            push_back(bool b)   { reserve(m_size + 1); m_items[m_size++] = b; }
+            void            resize  (size_t n)  {
+                reserve(n);
+                std:: fill(m_items.get() + (m_size < n ? m_size : n), m_items.get() + n, false);
+                m_size = n;
+            }
+            void            erase   (bool * b, bool * e) {
+                std:: copy(e, m_items.get() + m_size, b);
+                m_size -= static_cast<size_t>(e - b);
+            }
+        };
+
+        template<typename T>
+        using batch_buffer_t = std::conditional_t< std::is_same<T, bool>{}, bool_batch_buffer, std::vector<T> >;
+    }
+
+    template<typename R, typename Policy>
+    struct buffered_batches_range
     {
-        static_assert( is_range_v<R> ,"");
+        static_assert(!std::is_reference<R>{} ,"");
+        using val_type = pull_type_t<R>;
+        static_assert(!std::is_reference<val_type>{} ,"");
+        using view_type = pair_of_iterators<val_type*, val_type*>;
+
+        R                               m_r;
+        Policy                          m_policy;
+        impl:: batch_buffer_t<val_type> m_buffer;   // the current batch is at the start
+        size_t                          m_batch;    // the size of the current batch
+        view_type                       m_current;
+
+        buffered_batches_range(R && r, Policy policy)
+        : m_r(std::move(r)), m_policy(std::move(policy)), m_buffer(), m_batch(0), m_current()
+        { fill(); }
+
+        buffered_batches_range(buffered_batches_range const & other)
+        : m_r(other.m_r), m_policy(other.m_policy), m_buffer(other.m_buffer), m_batch(other.m_batch), m_current()
+        { resume_batch(other); }
+        buffered_batches_range(buffered_batches_range && other)
+        : m_r(std::move(other.m_r)), m_policy(std::move(other.m_policy)), m_buffer(), m_batch(other.m_batch), m_current()
+        {
+            m_buffer.swap(other.m_buffer);  // the items stay where they are, so 'm_current' is still valid
+            m_current = other.m_current;
+            other.m_batch = 0;
+        }
 
-        return {std::move(r)};
+        void
+        fill() {
+            m_buffer.erase(m_buffer.begin(), m_buffer.begin() + static_cast<std::ptrdiff_t>(m_batch));
+            m_batch = m_policy.fill_batch(m_r, m_buffer);
+            m_current = view_type{ m_buffer.data(), m_buffer.data() + m_batch };
+        }
+        void
+        resume_batch(buffered_batches_range const & other) {
+            val_type * b = m_buffer.data();
+            m_current = view_type{ b + (other.m_current.first - other.m_buffer.data()), b + m_batch };
+        }
+
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+
+        template<typename M> static bool
+        orange_empty      (M &m) { return m.m_batch == 0; }
+
+        template<typename M> static void
+        orange_advance    (M &m) { m.fill(); }
+
+        template<typename M> static auto
+        orange_front      (M &m)
+        -> view_type &
+        { return m.m_current; }
+    };
+
+    // slice with 'size' means one position per item, so we can slice out the batches
+    namespace impl {
+        template<typename R, bool = is_sliceable_v<R> && has_trait_size<R&> >
+        struct can_slice_into_batches : std::false_type {};
+        template<typename R>
+        struct can_slice_into_batches<R, true>
+            : std::integral_constant<bool, has_trait_size<decltype(orange::slice(std::declval<R&>(), size_t(0), size_t(0)))&>> {};
     }
+    template<typename R> constexpr bool
+    can_slice_into_batches = impl:: can_slice_into_batches<R>{};
+
+    template<typename R, typename Policy
+            , SFINAE_ENABLE_IF_CHECK( can_slice_into_batches<R> )>
+    auto constexpr
+    make_batches_range(R && r, Policy policy)
+    { return batches_range<R, Policy>{ std::move(r), std::move(policy) }; }
+
+    template<typename R, typename Policy
+            , SFINAE_ENABLE_IF_CHECK( !can_slice_into_batches<R> )>
+    auto
+    make_batches_range(R && r, Policy policy)
+    { return buffered_batches_range<R, Policy>{ std::move(r), std::move(policy) }; }
+
+    template<typename R>
+    auto constexpr
+    operator| (forward_this_with_a_tag<R,chunk_tag_t> f, size_t n)
+    { return make_batches_range(std::move(f.m_r), impl:: chunk_of_n{ n == 0 ? 1 : n }); }
+
+    template<typename R, typename Key>
+    auto constexpr
+    operator| (forward_this_with_a_tag<R,group_by_tag_t> f, Key && key)
+    { return make_batches_range(std::move(f.m_r), impl:: runs_of_equal_keys<std::decay_t<Key>>{ std::forward<Key>(key) }); }
 
     namespace testing_namespace {
         static_assert( 10 ==  (ints(5) | accumulate)  ,"");
+        static_assert( is_contiguous_iterator_v< std::vector<int>::const_iterator >     ,"");
+        static_assert(!is_contiguous_iterator_v< std::vector<bool>::const_iterator >    ,"");
         constexpr double x[] = {1.0, 2.7, 3.14};
         static_assert(1.0 + 2.7 + 3.14 == (as_range(std::begin(x), std::end(x)) | accumulate) ,"");
         static_assert(1.0 + 2.7 + 3.14 == (as_range(x)                          | accumulate) ,"");
@@ -1216,6 +4284,70 @@ namespace orange {
         static_assert(30 == (ints(10) |filter| greater_than_5_t{}   |accumulate) ,"");
         static_assert(-30 == (ints(10) |filter| greater_than_5_t{} |mapr| negate_t{}   |accumulate) ,"");
 
+        template<typename R>
+        constexpr size_hint_t
+        size_hint_of(R r) { return orange:: size_hint(r); }
+
+        constexpr
+        bool size_hint_is(size_hint_t h, enum_size_hint kind, size_t n)
+        { return h.m_kind == kind && h.m_n == n; }
+
+        static_assert(size_hint_is(size_hint_of( ints(3,10)                         ), enum_size_hint::exact       ,  7) ,"");
+        static_assert(size_hint_is(size_hint_of( replicate(5, 100)                  ), enum_size_hint::exact       ,  5) ,"");
+        static_assert(size_hint_is(size_hint_of( as_range(x)                        ), enum_size_hint::exact       ,  3) ,"");
+        static_assert(size_hint_is(size_hint_of( ints(10) |mapr| negate_t{}         ), enum_size_hint::exact       , 10) ,"");
+        static_assert(size_hint_is(size_hint_of( ints(10) |filter| even_t{}         ), enum_size_hint::upper_bound , 10) ,"");
+        static_assert(size_hint_is(size_hint_of( ints(10) |filter| even_t{} |filter| odd_t{} ), enum_size_hint::upper_bound ,  0) ,"");
+        static_assert(size_hint_is(size_hint_of( as_range(x) |mapr| negate_t{} |mapr| negate_t{} ), enum_size_hint::exact, 3) ,"");
+        static_assert(size_hint_is(min_size_hint({enum_size_hint::exact, 4}, {enum_size_hint::upper_bound, 3}), enum_size_hint::upper_bound, 3) ,"");
+        static_assert(size_hint_is(min_size_hint({enum_size_hint::exact, 4}, {enum_size_hint::lower_bound, 9}), enum_size_hint::exact, 4) ,"");
+        static_assert(size_hint_is(min_size_hint({enum_size_hint::exact, 4}, {enum_size_hint::unknown    , 0}), enum_size_hint::upper_bound, 4) ,"");
+        static_assert(size_hint_is(min_size_hint({enum_size_hint::lower_bound, 4}, {enum_size_hint::unknown, 0}), enum_size_hint::unknown, 0) ,"");
+
+        static_assert( can_pull_in_blocks< decltype( ints(10) |filter| odd_t{} |mapr| negate_t{} ) > ,"");
+        static_assert(!can_pull_in_blocks< std::pair<int*,int*> >                                      ,"");
+        static_assert( can_map_in_blocks < decltype( ints(10) ) >                                       ,"");
+        static_assert( can_pull_in_blocks< decltype( as_range(std::array<int,3>{}) ) >                 ,"");
+        static_assert(!can_map_in_blocks < decltype( as_range(std::array<int,3>{}) ) >                 ,""); // 'front' is a reference
+
+        template<typename R>
+        constexpr int
+        sum_of_pull_n_in_threes(R r) {
+            int block[3] {};
+            int total = 0;
+            size_t got = 0;
+            do {
+                got = orange:: pull_n(r, block, 3);
+                for(size_t i = 0; i<got; ++i)
+                    total += block[i] * int(got);   // weighted by the block size, to check the blocking
+            } while(got == 3);
+            return total;
+        }
+        static_assert( 0+1*3+2*3 +3*3+4*3+5*3 +6*3+7*3+8*3 +9*1 == sum_of_pull_n_in_threes( ints(10)                   ) ,"");
+        static_assert(   1*3+3*3+5*3 + 7*2+9*2                  == sum_of_pull_n_in_threes( ints(10) |filter| odd_t{}  ) ,"");
+        static_assert(  -1*3-3*3-5*3 - 7*2-9*2                  == sum_of_pull_n_in_threes( ints(10) |filter| odd_t{} |mapr| negate_t{} ) ,"");
+        static_assert(   0*3+2*3+4*3 + 6*2+8*2                  == sum_of_pull_n_in_threes( ints(10) |mapr| negate_t{} |filter| even_t{} |mapr| negate_t{} ) ,"");
+
+        // '|mapr|' after '|mapr|' is one range, and so is '|filter|' after '|mapr|'
+        static_assert(std::is_same< decltype( ints(10) |mapr| negate_t{} |mapr| negate_t{} )
+                                  , mapping_range<decltype(ints(10)), impl::composed_function<negate_t, negate_t>> >{} ,"");
+        static_assert(std::is_same< decltype( ints(10) |mapr| negate_t{} |filter| even_t{} )
+                                  , map_filter_range<decltype(ints(10)), negate_t, even_t> >{} ,"");
+        static_assert( 45 == (ints(10) |mapr| negate_t{} |mapr| negate_t{} |accumulate) ,"");
+        static_assert(-20 == (ints(10) |mapr| negate_t{} |filter| even_t{} |accumulate) ,"");
+
+        struct counted_negate_t {
+            int * m_calls;
+            constexpr int operator() (int x) const { ++*m_calls; return -x; }
+        };
+        constexpr int
+        calls_to_map_before_filter() {
+            int calls = 0;
+            auto sum = ints(10) |mapr| counted_negate_t{&calls} |filter| even_t{} |accumulate;
+            return sum == -20 ? calls : -1;
+        }
+        static_assert( 10 == calls_to_map_before_filter() ,"");
+
 
         struct dummy_int_range_with_pull_and_empty_only {
             int m_i = 0;
@@ -1388,122 +4520,666 @@ namespace orange {
     struct zip_helper { // This is to replace a capturing lambda. The only reason is that this is constexpr
         Z & m_z;
 
-        template<size_t ... Indices> auto constexpr
-        zip_empty(std::index_sequence<Indices...>)
-        -> bool
-        {
-            return   !all_true(!orange::empty ( std::template get<Indices>(m_z.m_ranges)) ... );
+        template<size_t ... Indices> auto constexpr
+        zip_empty(std::index_sequence<Indices...>)
+        -> bool
+        {
+            return   !all_true(!orange::empty ( std::template get<Indices>(m_z.m_ranges)) ... );
+        }
+
+        template<size_t ... Indices> auto constexpr
+        zip_advance(std::index_sequence<Indices...>)
+        -> void
+        {
+            orange_utils:: ignore(( orange::advance ( std::template get<Indices>(m_z.m_ranges)) ,0)...);
+        }
+
+        template<size_t ... Indices> auto constexpr
+        zip_front(std::index_sequence<Indices...>)
+        ->decltype(orange_utils::mk_tuple(orange:: get_one_item_to_return<Indices, my_policy>(m_z)...))
+        {   return orange_utils::mk_tuple(orange:: get_one_item_to_return<Indices, my_policy>(m_z)...); }
+    };
+
+    template< enum_zip_policy_on_references my_policy
+            , typename ... Rs >
+    struct zip_t {
+        static_assert( all_true( std::is_same<Rs, std::decay_t<Rs>>{}   ... ),"");
+        static_assert( all_true(  is_range_v<Rs>                        ... ),"");
+
+        constexpr static size_t N = sizeof...(Rs);
+        constexpr static size_t width = sizeof...(Rs);
+
+        using type_of_tuple = std:: tuple<std::decay_t<Rs>...>;
+        type_of_tuple m_ranges;
+
+        template< typename ... Ts
+            , std::enable_if_t<
+            all_true(std::is_same<std::decay_t<Ts>, std::decay_t<Rs> >{} ...)
+                    >* =nullptr
+            >
+        constexpr
+        zip_t(Ts && ... ts) : m_ranges(std::forward<Ts>(ts)...) {}
+
+        constexpr
+        zip_t(zip_t const &) = default;
+        constexpr
+        zip_t(zip_t      &&) = default;
+
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+        template<typename Z> static constexpr auto
+        orange_empty        (Z &  z)    ->decltype(auto)
+        {
+            return orange:: zip_helper<Z,my_policy>{z}.zip_empty(std::make_index_sequence<N>());
+        }
+
+        template<typename Z> static constexpr auto
+        orange_advance      (Z &  z)    ->void
+        {
+            return orange:: zip_helper<Z,my_policy>{z}.zip_advance(std::make_index_sequence<N>());
+        }
+
+        template<typename Z> static constexpr auto
+        orange_front        (Z &  z)    ->decltype(auto)
+        {
+            return orange:: zip_helper<Z,my_policy>{z}.zip_front(std::make_index_sequence<N>());
+        }
+
+        template<typename Z
+                ,size_t ... Indices
+                > static constexpr size_hint_t
+        orange_size_hint_helper (Z & z, std::index_sequence<Indices...>)   {
+            size_hint_t hints[] = { orange::size_hint(std::get<Indices>(z.m_ranges)) ... };
+            size_hint_t shortest = hints[0];
+            for(size_hint_t h : hints)
+                shortest = orange:: min_size_hint(shortest, h);
+            return shortest;
+        }
+        template<typename Z> static constexpr size_hint_t
+        orange_size_hint  (Z & z)   {
+            return orange_size_hint_helper(z, std:: make_index_sequence<Z::width>());
+        }
+
+        // zip can be sliced if all its ranges can be sliced, and have a 'size'
+        // (not merely a 'slice_length'), so that the positions line up.
+        template<typename Z
+                ,size_t ... Indices
+                > static constexpr auto
+        orange_size_helper (Z & z, std::index_sequence<Indices...>)
+        ->decltype(std::min ({ static_cast<size_t>(orange::size(std::get<Indices>(z.m_ranges))) ...  }))
+        {   return std::min ({ static_cast<size_t>(orange::size(std::get<Indices>(z.m_ranges))) ...  }); }
+        template<typename Z> static constexpr auto
+        orange_size       (Z & z)
+        ->decltype(orange_size_helper(z, std:: make_index_sequence<Z::width>()))
+        {   return orange_size_helper(z, std:: make_index_sequence<Z::width>()); }
+
+        template<typename Z
+                ,size_t ... Indices
+                > static constexpr auto
+        orange_slice_helper (Z & z, size_t b, size_t e, std::index_sequence<Indices...>)
+        ->zip_t< my_policy, std::decay_t<decltype(orange::slice(std::get<Indices>(z.m_ranges), b, e))> ... >
+        {   return zip_t< my_policy, std::decay_t<decltype(orange::slice(std::get<Indices>(z.m_ranges), b, e))> ... >
+                   { orange::slice(std::get<Indices>(z.m_ranges), b, e) ... }; }
+        template<typename Z> static constexpr auto
+        orange_slice      (Z & z, size_t b, size_t e)
+        ->decltype(void(orange_size(z)), orange_slice_helper(z, b, e, std:: make_index_sequence<Z::width>()))
+        {   return orange_slice_helper(z, b, e, std:: make_index_sequence<Z::width>()); }
+
+        // 'begin' and 'end' only where every range has random access. Otherwise
+        // range-based for uses the synthesized ones
+        template<typename Z
+                ,size_t ... Indices
+                > static constexpr auto
+        orange_end_helper (Z & z, std::index_sequence<Indices...>)
+        ->decltype(std::min ({  (end(std::get<Indices>(z.m_ranges))-begin(std::get<Indices>(z.m_ranges))) ...  }))
+        {   return std::min ({  (end(std::get<Indices>(z.m_ranges))-begin(std::get<Indices>(z.m_ranges))) ...  }); }
+        template<typename Z> static constexpr auto
+        orange_begin      (Z & z)
+        ->decltype(void(orange_end_helper(z, std:: make_index_sequence<Z::width>())), orange_zip_iterator<Z>{z, 0})
+        {   return orange_zip_iterator<Z>{z, 0}; }
+        template<typename Z> static constexpr auto
+        orange_end        (Z & z)
+        ->decltype(void(orange_end_helper(z, std:: make_index_sequence<Z::width>())), orange_zip_iterator<Z>{z, 0})
+        {   return orange_zip_iterator<Z> { z, (int)orange_end_helper(z, std:: make_index_sequence<Z::width>()) }; }
+    };
+
+    namespace impl {
+        constexpr size_t
+        smallest_of(size_t n) { return n; }
+        template<typename ... Ts>
+        constexpr size_t
+        smallest_of(size_t n, Ts ... ns) { return n < smallest_of(ns...) ? n : smallest_of(ns...); }
+    }
+
+    // as many as the shortest, and exact only if they all are
+    template<enum_zip_policy_on_references policy, typename ... Rs>
+    struct static_size_of<zip_t<policy, Rs...>, std::enable_if_t< sizeof...(Rs) != 0 && all_true( has_static_size<Rs> ... ) >>
+        : public static_size_is< impl:: smallest_of( static_size_of<Rs>::value ... )
+                               , all_true( has_exact_static_size<Rs> ... ) > {};
+
+    namespace impl {
+        template< enum_zip_policy_on_references policy, typename T
+                , SFINAE_ENABLE_IF_CHECK( policy == enum_zip_policy_on_references:: to_value )
+                > constexpr
+        std::decay_t<T> zip_lane_item(T && t)   { return std::forward<T>(t); }
+
+        template< enum_zip_policy_on_references policy, typename T
+                , SFINAE_ENABLE_IF_CHECK( policy == enum_zip_policy_on_references:: as_is )
+                > constexpr
+        T &&            zip_lane_item(T && t)   { return std::forward<T>(t); }
+
+        // the same tuple as 'zip_front' would give
+        template<enum_zip_policy_on_references policy, typename ... Vs>
+        struct zipped_lanes {
+            static constexpr bool dense = true;
+            std:: tuple<Vs...> m_vs;
+
+            template<size_t ... Indices> constexpr
+            size_t count_helper(std::index_sequence<Indices...>) const
+            {   return std::min ({ std::get<Indices>(m_vs).count() ... }); }
+            constexpr size_t    count()             const { return count_helper(std::index_sequence_for<Vs...>{}); }
+            constexpr bool      selected(size_t)    const { return true; }
+
+            template<size_t ... Indices> constexpr
+            auto at_helper(size_t i, std::index_sequence<Indices...>) const
+            ->decltype(orange_utils::mk_tuple( zip_lane_item<policy>(std::get<Indices>(m_vs).at(i)) ... ))
+            {   return orange_utils::mk_tuple( zip_lane_item<policy>(std::get<Indices>(m_vs).at(i)) ... ); }
+            constexpr decltype(auto)
+                                at(size_t i)        const { return at_helper(i, std::index_sequence_for<Vs...>{}); }
+        };
+    }
+
+    // a zip has lanes if all of its ranges have dense lanes, i.e. no '|filter|'
+    template<enum_zip_policy_on_references policy, typename ... Rs>
+    struct lanes_for< zip_t<policy, Rs...>
+                    , std::enable_if_t< all_true( decltype(lanes_for<Rs>::view(std::declval<Rs&>()))::dense ... ) >> {
+        template<size_t ... Indices>
+        static constexpr auto
+        view_helper(zip_t<policy, Rs...> & z, std::index_sequence<Indices...>)
+        ->impl:: zipped_lanes<policy, decltype(lanes_for<Rs>::view(std::declval<Rs&>())) ...>
+        {   return { std::make_tuple( lanes_for<Rs>::view(std::get<Indices>(z.m_ranges)) ... ) }; }
+
+        static constexpr auto
+        view(zip_t<policy, Rs...> & z)
+        {   return view_helper(z, std::index_sequence_for<Rs...>{}); }
+    };
+
+    // zip
+    template<typename ... Rs
+            , SFINAE_ENABLE_IF_CHECK( all_true(is_range_v<Rs>...) )
+            >
+    auto constexpr
+    zip(Rs && ... rs) {
+        return  zip_t<enum_zip_policy_on_references :: to_value, std::decay_t<Rs>...>
+                ( std::forward<Rs>(rs)...) ;
+    }
+
+    // zip_as_is
+    template<typename ... Rs
+            , SFINAE_ENABLE_IF_CHECK( all_true(is_range_v<Rs>...) )
+            >
+    auto constexpr
+    zip_as_is(Rs && ... rs) {
+        static_assert( true  ,""); // this assert saves "g++ (GCC) 5.5.0" from a crash about missing constructor!
+        return  zip_t<enum_zip_policy_on_references :: as_is, std::decay_t<Rs>...>
+                ( std::forward<Rs>(rs)...) ;
+    }
+
+
+    // If 'zip' or 'zip_as_is' is given a non-range, then apply 'as_range' and forward them
+    template<typename ... Rs
+            , SFINAE_ENABLE_IF_CHECK( !all_true(is_range_v<Rs>...) )
+            > auto constexpr
+    zip(Rs && ... rs)
+    -> decltype(auto)
+    { return zip( orange::as_range(std::forward<Rs>(rs))...) ; }
+
+    template<typename ... Rs
+            , SFINAE_ENABLE_IF_CHECK( !all_true(is_range_v<Rs>...) )
+            > auto constexpr
+    zip_as_is(Rs && ... rs)
+    -> decltype(auto)
+    { return zip_as_is( orange::as_range(std::forward<Rs>(rs))...) ; }
+
+    /*
+     * product  product_tiled
+     * =======  =============
+     *      'product(r1, r2)' is every pair of an item of 'r1' with an item of
+     *  'r2', as tuples like 'zip' gives, with 'r2' varying fastest:
+     *
+     *      product(ints(2), ints(3))   // (0,0) (0,1) (0,2) (1,0) (1,1) (1,2)
+     *
+     *  This is the nested loop that would otherwise be written as a '|mapr|'
+     *  that returns a range, followed by '|concat'. 'r2' is copied at the
+     *  start of each row, so it must be a range that can be read again from
+     *  a copy, such as 'ints' or 'as_range' of a container.
+     *      The positions, for 'slice' and the parallel modes, are the rows:
+     *  'slice(p, b, e)' is the product of 'slice(r1, b, e)' with all of 'r2'.
+     *  'rows()' and 'columns()' are the two ranges it was made from. A slice
+     *  starts at the start of its rows, so it should be taken before 'p' is
+     *  advanced.
+     *
+     *      'product_tiled(r1, r2, t1, t2)' has the same pairs, but in tiles of
+     *  't1' rows by 't2' columns: all of one tile, a row at a time, then the
+     *  next tile to the right. For large inputs, where one row of 'r2' is
+     *  bigger than the cache, each tile's 't1' items of 'r1' and 't2' items
+     *  of 'r2' stay in the cache while they're used. It needs random access
+     *  ('size' and 'front_at') in both. Its positions are the bands of 't1'
+     *  rows.
+     */
+    template<typename R1, typename R2>
+    struct product_range {
+        static_assert(!std::is_reference<R1>{},"");
+        static_assert(!std::is_reference<R2>{},"");
+        static_assert( is_range_v<R1>, "");
+        static_assert( is_range_v<R2>, "");
+
+        R1                                  m_r1;
+        R2                                  m_r2;       // the columns, from the start
+        orange_utils:: optional_value<R2>   m_row;      // the columns of the current row, from the current one
+
+        template<typename RR1, typename RR2>
+        constexpr
+        product_range(RR1 && r1, RR2 && r2)
+        : m_r1(std::forward<RR1>(r1)), m_r2(std::forward<RR2>(r2)), m_row()
+        {   m_row.emplace(m_r2); }
+
+        constexpr R1 const &    rows()      const { return m_r1; }
+        constexpr R2 const &    columns()   const { return m_r2; }
+
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+
+        // 'm_row' is only empty at the end of a row if 'r2' is empty
+        template<typename M> static constexpr bool
+        orange_empty      (M &m) { return orange::empty(m.m_r1) || orange::empty(*m.m_row); }
+
+        template<typename M> static constexpr auto
+        orange_front      (M &m)
+        ->decltype(orange_utils::mk_tuple( std::decay_t<decltype(orange::front(m.m_r1))>(orange::front(m.m_r1))
+                                         , std::decay_t<decltype(orange::front(*m.m_row))>(orange::front(*m.m_row)) ))
+        {   return orange_utils::mk_tuple( std::decay_t<decltype(orange::front(m.m_r1))>(orange::front(m.m_r1))
+                                         , std::decay_t<decltype(orange::front(*m.m_row))>(orange::front(*m.m_row)) ); }
+
+        template<typename M> static constexpr void
+        orange_advance    (M &m) {
+            orange::advance(*m.m_row);
+            if(orange::empty(*m.m_row)) {
+                orange::advance(m.m_r1);
+                m.m_row.emplace(m.m_r2);
+            }
+        }
+
+        template<typename M> static constexpr auto
+        orange_size       (M &m)
+        ->decltype( orange::size(m.m_r1) * orange::size(m.m_r2) )
+        {
+            size_t rows = orange::size(m.m_r1);
+            return rows == 0 ? 0 : (rows - 1) * orange::size(m.m_r2) + orange::size(*m.m_row);
+        }
+
+        template<typename M> static constexpr auto
+        orange_slice_length (M &m)
+        ->decltype( orange::slice_length(m.m_r1) )
+        {   return orange::slice_length(m.m_r1); }
+
+        template<typename M> static constexpr auto
+        orange_slice      (M &m, size_t b, size_t e)
+        ->product_range< std::decay_t<decltype(orange::slice(m.m_r1, b, e))>, R2 >
+        {   return { orange::slice(m.m_r1, b, e), m.m_r2 }; }
+    };
+
+    template<typename R1, typename R2>
+    struct static_size_of<product_range<R1,R2>, std::enable_if_t< has_static_size<R1> && has_static_size<R2> >>
+        : public static_size_is< static_size_of<R1>::value * static_size_of<R2>::value
+                               , has_exact_static_size<R1> && has_exact_static_size<R2> > {};
+
+    template<typename R1, typename R2>
+    struct product_tiled_range {
+        static_assert(!std::is_reference<R1>{},"");
+        static_assert(!std::is_reference<R2>{},"");
+        static_assert( is_range_v<R1>, "");
+        static_assert( is_range_v<R2>, "");
+
+        R1      m_r1;
+        R2      m_r2;
+        size_t  m_n1, m_n2;     // the sizes of 'r1' and 'r2'
+        size_t  m_t1, m_t2;     // the size of a tile
+        size_t  m_i0, m_j0;     // the top left of the current tile
+        size_t  m_i , m_j;      // within the current tile
+
+        template<typename RR1, typename RR2>
+        constexpr
+        product_tiled_range(RR1 && r1, RR2 && r2, size_t t1, size_t t2)
+        : m_r1(std::forward<RR1>(r1)), m_r2(std::forward<RR2>(r2))
+        , m_n1(orange::size(m_r1)), m_n2(orange::size(m_r2))
+        , m_t1(t1 > 0 ? t1 : 1), m_t2(t2 > 0 ? t2 : 1)
+        , m_i0(0), m_j0(0), m_i(0), m_j(0)
+        {}
+
+        constexpr R1 const &    rows()      const { return m_r1; }
+        constexpr R2 const &    columns()   const { return m_r2; }
+
+        constexpr size_t    tile_height()   const { return std::min(m_t1, m_n1 - m_i0); }
+        constexpr size_t    tile_width()    const { return std::min(m_t2, m_n2 - m_j0); }
+
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+
+        template<typename M> static constexpr bool
+        orange_empty      (M &m) { return m.m_i0 >= m.m_n1 || m.m_n2 == 0; }
+
+        template<typename M> static constexpr auto
+        orange_front      (M &m)
+        ->decltype(orange_utils::mk_tuple( std::decay_t<decltype(orange::front_at(m.m_r1, 0))>(orange::front_at(m.m_r1, 0))
+                                         , std::decay_t<decltype(orange::front_at(m.m_r2, 0))>(orange::front_at(m.m_r2, 0)) ))
+        {   return orange_utils::mk_tuple( std::decay_t<decltype(orange::front_at(m.m_r1, 0))>(orange::front_at(m.m_r1, m.m_i0 + m.m_i))
+                                         , std::decay_t<decltype(orange::front_at(m.m_r2, 0))>(orange::front_at(m.m_r2, m.m_j0 + m.m_j)) ); }
+
+        template<typename M> static constexpr void
+        orange_advance    (M &m) {
+            if(++m.m_j < m.tile_width())
+                return;
+            m.m_j = 0;
+            if(++m.m_i < m.tile_height())
+                return;
+            m.m_i = 0;
+            m.m_j0 += m.m_t2;
+            if(m.m_j0 < m.m_n2)
+                return;
+            m.m_j0 = 0;
+            m.m_i0 += m.m_t1;
         }
 
-        template<size_t ... Indices> auto constexpr
-        zip_advance(std::index_sequence<Indices...>)
-        -> void
-        {
-            orange_utils:: ignore(( orange::advance ( std::template get<Indices>(m_z.m_ranges)) ,0)...);
+        // all of the bands above, the tiles to the left in this band, and the rows and columns so far in this tile
+        template<typename M> static constexpr size_t
+        orange_size       (M &m) {
+            if(orange_empty(m))
+                return 0;
+            size_t done = m.m_i0 * m.m_n2 + m.tile_height() * m.m_j0 + m.m_i * m.tile_width() + m.m_j;
+            return m.m_n1 * m.m_n2 - done;
         }
 
-        template<size_t ... Indices> auto constexpr
-        zip_front(std::index_sequence<Indices...>)
-        ->decltype(orange_utils::mk_tuple(orange:: get_one_item_to_return<Indices, my_policy>(m_z)...))
-        {   return orange_utils::mk_tuple(orange:: get_one_item_to_return<Indices, my_policy>(m_z)...); }
+        template<typename M> static constexpr size_t
+        orange_slice_length (M &m) { return (m.m_n1 + m.m_t1 - 1) / m.m_t1; }
+
+        template<typename M> static constexpr auto
+        orange_slice      (M &m, size_t b, size_t e)
+        ->product_tiled_range< std::decay_t<decltype(orange::slice(m.m_r1, b, e))>, R2 >
+        {   return { orange::slice(m.m_r1, std::min(b * m.m_t1, m.m_n1), std::min(e * m.m_t1, m.m_n1)), m.m_r2, m.m_t1, m.m_t2 }; }
     };
 
-    template< enum_zip_policy_on_references my_policy
-            , typename ... Rs >
-    struct zip_t {
-        static_assert( all_true( std::is_same<Rs, std::decay_t<Rs>>{}   ... ),"");
-        static_assert( all_true(  is_range_v<Rs>                        ... ),"");
+    template<typename R1, typename R2>
+    struct static_size_of<product_tiled_range<R1,R2>, std::enable_if_t< has_static_size<R1> && has_static_size<R2> >>
+        : public static_size_is< static_size_of<R1>::value * static_size_of<R2>::value
+                               , has_exact_static_size<R1> && has_exact_static_size<R2> > {};
 
-        constexpr static size_t N = sizeof...(Rs);
-        constexpr static size_t width = sizeof...(Rs);
+    template<typename R1, typename R2
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<std::decay_t<R1>> && is_range_v<std::decay_t<R2>> )
+            >
+    constexpr auto
+    product(R1 && r1, R2 && r2)
+    ->product_range<std::decay_t<R1>, std::decay_t<R2>>
+    {   return { std::forward<R1>(r1), std::forward<R2>(r2) }; }
 
-        using type_of_tuple = std:: tuple<std::decay_t<Rs>...>;
-        type_of_tuple m_ranges;
+    template<typename R1, typename R2
+            , SFINAE_ENABLE_IF_CHECK( !(is_range_v<std::decay_t<R1>> && is_range_v<std::decay_t<R2>>) )
+            >
+    constexpr auto
+    product(R1 && r1, R2 && r2)
+    ->decltype(product( as_range(std::forward<R1>(r1)), as_range(std::forward<R2>(r2)) ))
+    {   return product( as_range(std::forward<R1>(r1)), as_range(std::forward<R2>(r2)) ); }
 
-        template< typename ... Ts
-            , std::enable_if_t<
-            all_true(std::is_same<std::decay_t<Ts>, std::decay_t<Rs> >{} ...)
-                    >* =nullptr
+    template<typename R1, typename R2
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<std::decay_t<R1>> && is_range_v<std::decay_t<R2>> )
             >
-        constexpr
-        zip_t(Ts && ... ts) : m_ranges(std::forward<Ts>(ts)...) {}
+    constexpr auto
+    product_tiled(R1 && r1, R2 && r2, size_t t1, size_t t2)
+    ->product_tiled_range<std::decay_t<R1>, std::decay_t<R2>>
+    {   return { std::forward<R1>(r1), std::forward<R2>(r2), t1, t2 }; }
 
-        constexpr
-        zip_t(zip_t const &) = default;
-        constexpr
-        zip_t(zip_t      &&) = default;
+    template<typename R1, typename R2
+            , SFINAE_ENABLE_IF_CHECK( !(is_range_v<std::decay_t<R1>> && is_range_v<std::decay_t<R2>>) )
+            >
+    constexpr auto
+    product_tiled(R1 && r1, R2 && r2, size_t t1, size_t t2)
+    ->decltype(product_tiled( as_range(std::forward<R1>(r1)), as_range(std::forward<R2>(r2)), t1, t2 ))
+    {   return product_tiled( as_range(std::forward<R1>(r1)), as_range(std::forward<R2>(r2)), t1, t2 ); }
 
-        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
-        template<typename Z> static constexpr auto
-        orange_empty        (Z &  z)    ->decltype(auto)
-        {
-            return orange:: zip_helper<Z,my_policy>{z}.zip_empty(std::make_index_sequence<N>());
+    /*
+     * merge   |merge_all
+     * =====   ==========
+     *      Merge sorted ranges into one sorted range, lazily. 'merge(r1, r2, ...)'
+     *  takes the ranges directly, like 'zip', and '|merge_all' takes a range of
+     *  ranges. Each is compared with '<', and where fronts are equal the earlier
+     *  range goes first, so the merge is stable.
+     *      The ranges are in a binary heap, ordered by their fronts, so each
+     *  item costs O(log k) comparisons for 'k' ranges, and the only memory is
+     *  for the 'k' ranges.
+     */
+    namespace impl {
+        // 'm.before(a,b)' compares the ranges at positions 'a' and 'b'
+        template<typename M, typename Heap>
+        constexpr void
+        heap_sift_up    (M & m, Heap & heap, size_t pos) {
+            while(pos > 0) {
+                size_t parent = (pos - 1) / 2;
+                if(!m.before(heap[pos], heap[parent]))
+                    return;
+                size_t tmp = heap[pos]; heap[pos] = heap[parent]; heap[parent] = tmp;
+                pos = parent;
+            }
+        }
+        template<typename M, typename Heap>
+        constexpr void
+        heap_sift_down  (M & m, Heap & heap, size_t heap_size, size_t pos) {
+            while(true) {
+                size_t first = pos;
+                size_t l = 2 * pos + 1;
+                size_t r = l + 1;
+                if(l < heap_size && m.before(heap[l], heap[first])) first = l;
+                if(r < heap_size && m.before(heap[r], heap[first])) first = r;
+                if(first == pos)
+                    return;
+                size_t tmp = heap[pos]; heap[pos] = heap[first]; heap[first] = tmp;
+                pos = first;
+            }
         }
+    }
 
-        template<typename Z> static constexpr auto
-        orange_advance      (Z &  z)    ->void
+    /*  merge_t
+     *      The ranges can be of different types, so the front of each is kept
+     *  here, as their common type, to compare them without looking up the
+     *  range by its index each time.
+     */
+    template<typename ... Rs>
+    struct merge_t {
+        static_assert(all_true(!std::is_reference<Rs>{}...) ,"");
+        static constexpr size_t width = sizeof...(Rs);
+        using val_type = std::common_type_t< std::decay_t<decltype(orange::front(std::declval<Rs&>()))> ... >;
+
+        std::tuple<Rs...>                       m_ranges;
+        orange_utils:: optional_value<val_type> m_heads[width];
+        size_t                                  m_heap[width];  // indices into 'm_ranges', by their heads
+        size_t                                  m_heap_size;
+
+        template<typename ... Ts>
+        constexpr explicit
+        merge_t(from_items_t, Ts && ... ts)
+        : m_ranges(std::forward<Ts>(ts)...), m_heads{}, m_heap{}, m_heap_size(0)
         {
-            return orange:: zip_helper<Z,my_policy>{z}.zip_advance(std::make_index_sequence<N>());
+            load_all_heads(std::index_sequence_for<Rs...>{});
+            for(size_t i = 0; i<width; ++i) {
+                if(m_heads[i].has_value()) {
+                    m_heap[m_heap_size] = i;
+                    impl:: heap_sift_up(*this, m_heap, m_heap_size++);
+                }
+            }
         }
 
-        template<typename Z> static constexpr auto
-        orange_front        (Z &  z)    ->decltype(auto)
-        {
-            return orange:: zip_helper<Z,my_policy>{z}.zip_front(std::make_index_sequence<N>());
+        constexpr bool
+        before(size_t a, size_t b) const {
+            if(*m_heads[a] < *m_heads[b]) return true;
+            if(*m_heads[b] < *m_heads[a]) return false;
+            return a < b;
         }
 
-        template<typename Z> static constexpr decltype(auto)
-        orange_begin      (Z & z)   {
-            return orange_zip_iterator<Z>{z, 0};
+        template<size_t I>
+        constexpr void
+        load_head() {
+            auto & r = std::get<I>(m_ranges);
+            if(orange::empty(r))
+                m_heads[I].reset();
+            else
+                m_heads[I].emplace(orange::front(r));
         }
-        template<typename Z
-                ,size_t ... Indices
-                > static constexpr decltype(auto)
-        orange_end_helper (Z & z, std::index_sequence<Indices...>)   {
-            return std::min ({  (end(std::get<Indices>(z.m_ranges))-begin(std::get<Indices>(z.m_ranges))) ...  });
+        template<size_t ... Is>
+        constexpr void
+        load_all_heads(std::index_sequence<Is...>)
+        {   orange_utils:: ignore( (load_head<Is>(),0) ... ); }
+
+        template<size_t I>
+        constexpr void
+        advance_at(size_t i, std::integral_constant<size_t, I>) {
+            if(i == I) {
+                orange::advance(std::get<I>(m_ranges));
+                load_head<I>();
+            }
+            else
+                advance_at(i, std::integral_constant<size_t, I+1>{});
         }
-        template<typename Z> static constexpr decltype(auto)
-        orange_end        (Z & z)   {
-            return orange_zip_iterator<Z> { z, (int)orange_end_helper(z, std:: make_index_sequence<Z::width>()) };
+        constexpr void
+        advance_at(size_t, std::integral_constant<size_t, width>) {}
+
+        template<size_t ... Is>
+        constexpr auto
+        size_helper(std::index_sequence<Is...>)
+        ->decltype( orange_utils:: ignore(orange::size(std::get<Is>(m_ranges))...), size_t{} )
+        {
+            size_t sizes[] = { size_t(0), static_cast<size_t>(orange::size(std::get<Is>(m_ranges))) ... };
+            size_t total = 0;
+            for(size_t s : sizes)
+                total += s;
+            return total;
         }
-    };
 
-    // zip
-    template<typename ... Rs
-            , SFINAE_ENABLE_IF_CHECK( all_true(is_range_v<Rs>...) )
-            >
-    auto constexpr
-    zip(Rs && ... rs) {
-        return  zip_t<enum_zip_policy_on_references :: to_value, std::decay_t<Rs>...>
-                ( std::forward<Rs>(rs)...) ;
-    }
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+
+        template<typename M> static constexpr bool
+        orange_empty      (M &m) { return m.m_heap_size == 0; }
+
+        template<typename M> static constexpr auto
+        orange_front      (M &m)
+        -> val_type &
+        { return *m.m_heads[m.m_heap[0]]; }
+
+        template<typename M> static constexpr void
+        orange_advance    (M &m)
+        {
+            size_t i = m.m_heap[0];
+            m.advance_at(i, std::integral_constant<size_t, 0>{});
+            if(!m.m_heads[i].has_value())
+                m.m_heap[0] = m.m_heap[--m.m_heap_size];
+            impl:: heap_sift_down(m, m.m_heap, m.m_heap_size, 0);
+        }
+
+        // the heads are still in the ranges, so this is just the sum of their sizes
+        template<typename M> static constexpr auto
+        orange_size       (M &m)
+        ->decltype(m.size_helper(std::index_sequence_for<Rs...>{}))
+        {   return m.size_helper(std::index_sequence_for<Rs...>{}); }
+    };
 
-    // zip_as_is
     template<typename ... Rs
             , SFINAE_ENABLE_IF_CHECK( all_true(is_range_v<Rs>...) )
             >
     auto constexpr
-    zip_as_is(Rs && ... rs) {
-        static_assert( true  ,""); // this assert saves "g++ (GCC) 5.5.0" from a crash about missing constructor!
-        return  zip_t<enum_zip_policy_on_references :: as_is, std::decay_t<Rs>...>
-                ( std::forward<Rs>(rs)...) ;
-    }
-
+    merge(Rs && ... rs)
+    {   return merge_t<std::decay_t<Rs>...>( from_items_t{}, std::forward<Rs>(rs)... ); }
 
-    // If 'zip' or 'zip_as_is' is given a non-range, then apply 'as_range' and forward them
     template<typename ... Rs
             , SFINAE_ENABLE_IF_CHECK( !all_true(is_range_v<Rs>...) )
             > auto constexpr
-    zip(Rs && ... rs)
+    merge(Rs && ... rs)
     -> decltype(auto)
-    { return zip( orange::as_range(std::forward<Rs>(rs))...) ; }
+    { return merge( orange::as_range(std::forward<Rs>(rs))...) ; }
 
-    template<typename ... Rs
-            , SFINAE_ENABLE_IF_CHECK( !all_true(is_range_v<Rs>...) )
-            > auto constexpr
-    zip_as_is(Rs && ... rs)
-    -> decltype(auto)
-    { return zip_as_is( orange::as_range(std::forward<Rs>(rs))...) ; }
+    /*  merge_all_helper
+     *      Here, the ranges are all of the same type, so they are kept in a
+     *  'vector' and compared by their fronts directly. If 'front' is expensive
+     *  for them, consider '|memoize' on each one first.
+     */
+    template<typename R>
+    struct merge_all_helper
+    {
+        static_assert(!std::is_reference<R>{} ,"");
+        using range_type = std::decay_t<pull_type_t<R>>;
+        static_assert( is_range_v<range_type> ,"");
+
+        std:: vector<range_type>    m_ranges;   // the empty ones are dropped
+        std:: vector<size_t>        m_heap;     // indices into 'm_ranges', by their fronts
+
+        merge_all_helper(R && r)
+        : m_ranges(), m_heap()
+        {
+            orange:: reserve_for_size_hint(m_ranges, orange::size_hint(r));
+            while(!orange::empty(r)) {
+                auto one = orange::pull(r);
+                if(!orange::empty(one))
+                    m_ranges.push_back(std::move(one));
+            }
+            for(size_t i = 0; i<m_ranges.size(); ++i) {
+                m_heap.push_back(i);
+                impl:: heap_sift_up(*this, m_heap, i);
+            }
+        }
+
+        bool
+        before(size_t a, size_t b) {
+            if(orange::front(m_ranges[a]) < orange::front(m_ranges[b])) return true;
+            if(orange::front(m_ranges[b]) < orange::front(m_ranges[a])) return false;
+            return a < b;
+        }
+
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+
+        template<typename M> static bool
+        orange_empty      (M &m) { return m.m_heap.empty(); }
+
+        template<typename M> static auto
+        orange_front      (M &m)
+        ->decltype(orange::front(m.m_ranges[0]))
+        {   return orange::front(m.m_ranges[m.m_heap[0]]); }
+
+        template<typename M> static void
+        orange_advance    (M &m)
+        {
+            range_type & winner = m.m_ranges[m.m_heap[0]];
+            orange::advance(winner);
+            if(orange::empty(winner)) {
+                m.m_heap[0] = m.m_heap.back();
+                m.m_heap.pop_back();
+            }
+            impl:: heap_sift_down(m, m.m_heap, m.m_heap.size(), 0);
+        }
+
+        template<typename M> static auto
+        orange_size       (M &m)
+        ->decltype(size_t(orange::size(m.m_ranges[0])))
+        {
+            size_t total = 0;
+            for(auto & one : m.m_ranges)
+                total += static_cast<size_t>(orange::size(one));
+            return total;
+        }
+    };
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> )
+            >
+    auto
+    operator| (R r, merge_all_tag_t)
+    -> merge_all_helper<R>
+    {
+        static_assert( is_range_v<R> ,"");
+        return {std::move(r)};
+    }
 
     namespace testing_namespace {
         template<typename T>
@@ -1684,6 +5360,235 @@ namespace orange {
     -> apply_pack_helper<F>
     { return {std::forward<F>(f)}; }
 
+    /*
+     * zip_columns
+     * ===========
+     *      'zip_columns(a1, a2, ...)' is like 'zip_as_is', but only for
+     *  contiguous ranges (those with 'data' and 'size', such as arrays and
+     *  vectors). It keeps one pointer per column and one shared index,
+     *  instead of a range per column, so each step is a single increment
+     *  and the compiler sees plain stride-1 loads from every column.
+     *
+     *  -   the front is a tuple of references, one into each column.
+     *  -   with  '|mapr| apply_pack % f', the columns are passed directly
+     *      to 'f' as separate arguments; no tuple is built.
+     *  -   'columns(z)' gives a tuple of raw pointers, one per column, to
+     *      the current position, and 'orange::size(z)' says how many
+     *      positions remain, for consumers that want to work in batches.
+     *
+     *  The columns aren't copied or owned, so the arguments must be lvalues
+     *  that outlive the zip. If the columns have different lengths, the
+     *  zip stops at the shortest.
+     */
+    template<typename ... Ts>
+    struct zip_columns_t {
+        std:: tuple<Ts*...>     m_columns;  // each is at position 0, the index is kept separately
+        size_t                  m_i;
+        size_t                  m_n;
+
+        constexpr static size_t width = sizeof...(Ts);
+
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+
+        template<typename Z> static constexpr bool
+        orange_empty      (Z & z)   { return z.m_i >= z.m_n; }
+
+        template<typename Z> static constexpr void
+        orange_advance    (Z & z)   { ++z.m_i; }
+
+        template<typename Z> static constexpr size_t
+        orange_size       (Z & z)   { return z.m_i >= z.m_n ? 0 : z.m_n - z.m_i; }
+
+        template<typename Z, size_t ... Indices> static constexpr auto
+        front_helper      (Z & z, std::index_sequence<Indices...>)
+        ->std:: tuple<Ts&...>
+        {   return std:: tuple<Ts&...>{ std::get<Indices>(z.m_columns)[z.m_i] ... }; }
+        template<typename Z> static constexpr auto
+        orange_front      (Z & z)
+        ->std:: tuple<Ts&...>
+        {   return front_helper(z, std::index_sequence_for<Ts...>{}); }
+
+        template<typename Z, typename F, size_t ... Indices> static constexpr auto
+        front_mapped_helper (Z & z, apply_pack_helper<F> const & f, std::index_sequence<Indices...>)
+        ->decltype(f.m_f( std::get<Indices>(z.m_columns)[z.m_i] ... ))
+        {   return f.m_f( std::get<Indices>(z.m_columns)[z.m_i] ... ); }
+        template<typename Z, typename F> static constexpr auto
+        orange_front_mapped (Z & z, apply_pack_helper<F> const & f)
+        ->decltype(front_mapped_helper(z, f, std::index_sequence_for<Ts...>{}))
+        {   return front_mapped_helper(z, f, std::index_sequence_for<Ts...>{}); }
+
+        template<typename Z, size_t ... Indices> static constexpr auto
+        slice_helper      (Z & z, size_t b, size_t e, std::index_sequence<Indices...>)
+        ->zip_columns_t
+        {   return { std:: tuple<Ts*...>{ std::get<Indices>(z.m_columns) + z.m_i + b ... }, 0, e - b }; }
+        template<typename Z> static constexpr auto
+        orange_slice      (Z & z, size_t b, size_t e)
+        ->zip_columns_t
+        {   return slice_helper(z, b, e, std::index_sequence_for<Ts...>{}); }
+    };
+
+    namespace impl {
+        template<typename C>
+        using column_type_t = std::remove_pointer_t<decltype( orange::data(std::declval< std::remove_reference_t<decltype(as_range(std::declval<C&>()))> & >()) )>;
+
+        template<typename C>
+        auto constexpr
+        column_data(C & c) -> column_type_t<C> *
+        {   auto r = as_range(c); return orange::data(r); }
+
+        template<typename C>
+        auto constexpr
+        column_size(C & c) -> size_t
+        {   auto r = as_range(c); return static_cast<size_t>(orange::size(r)); }
+    }
+
+    template<typename ... Cs>
+    auto constexpr
+    zip_columns(Cs & ... cs)
+    -> zip_columns_t< impl::column_type_t<Cs> ... >
+    {
+        static_assert(sizeof...(Cs) > 0 ,"");
+        return { std:: tuple<impl::column_type_t<Cs> * ...>{ impl::column_data(cs) ... }
+               , 0
+               , std::min({ impl::column_size(cs) ... })
+               };
+    }
+
+    //  columns(z) - the raw pointers of each column, at the current position
+    template<typename ... Ts, size_t ... Indices>
+    auto constexpr
+    columns_helper(zip_columns_t<Ts...> const & z, std::index_sequence<Indices...>)
+    -> std:: tuple<Ts*...>
+    {   return std:: tuple<Ts*...>{ std::get<Indices>(z.m_columns) + z.m_i ... }; }
+
+    template<typename ... Ts>
+    auto constexpr
+    columns(zip_columns_t<Ts...> const & z)
+    -> std:: tuple<Ts*...>
+    {   return columns_helper(z, std::index_sequence_for<Ts...>{}); }
+
+    namespace impl {
+        template<typename ... Ts>
+        struct column_lanes {
+            static constexpr bool dense = true;
+            std:: tuple<Ts*...> m_columns;
+            size_t              m_n;
+
+            template<size_t ... Indices> constexpr
+            std:: tuple<Ts&...> at_helper(size_t i, std::index_sequence<Indices...>) const
+            {   return std:: tuple<Ts&...>{ std::get<Indices>(m_columns)[i] ... }; }
+
+            constexpr size_t    count()             const { return m_n; }
+            constexpr bool      selected(size_t)    const { return true; }
+            constexpr std:: tuple<Ts&...>
+                                at(size_t i)        const { return at_helper(i, std::index_sequence_for<Ts...>{}); }
+        };
+    }
+
+    template<typename ... Ts>
+    struct lanes_for<zip_columns_t<Ts...>> {
+        static constexpr auto
+        view(zip_columns_t<Ts...> & z)
+        {   return impl:: column_lanes<Ts...>{ columns(z), orange::size(z) }; }
+    };
+
+    /*
+     * |unzip<I>    |unzip_collect
+     * ==========   ==============
+     *      The other direction, for any range whose items are tuples (or
+     *  pairs), such as a 'zip' after a '|filter|'.
+     *
+     *  -   '|unzip<I>' is the range of column 'I' only. It's a '|mapr|', so
+     *      nothing is copied: where the items are tuples of references, as
+     *      from 'zip_as_is' or 'zip_columns', the front is a reference into
+     *      the column. Over a 'zip' or
+     *      'zip_columns' it still has 'lanes_for', for '|accumulate'.
+     *  -   '|unzip_collect' is a tuple of vectors, one per column, filled in
+     *      a single pass, with capacity reserved from the size hint.
+     *
+     *      auto cols = zip(names, ages) |filter| adults |unzip_collect;
+     *      std:: vector<int> & adult_ages = std::get<1>(cols);
+     */
+    namespace impl {
+        // a value where the item has a value, a reference where it has a reference
+        template<size_t I>
+        struct column_t {
+            constexpr column_t() {}
+            template<typename Tup>
+            constexpr auto
+            operator() (Tup && t) const
+            -> std:: tuple_element_t<I, std::decay_t<Tup>>
+            {   return std::get<I>(std::forward<Tup>(t)); }
+        };
+
+        template<typename Row, typename Indices = std::make_index_sequence<std::tuple_size<Row>::value>>
+        struct unzip_columns;
+        template<typename Row, size_t ... Is>
+        struct unzip_columns<Row, std::index_sequence<Is...>> {
+            using type = std:: tuple< std::vector<std::decay_t<std::tuple_element_t<Is, Row>>> ... >;
+
+            static void
+            reserve(type & cols, size_hint_t h)
+            {
+                int ignored[] = { (orange:: reserve_for_size_hint(std::get<Is>(cols), h), 0) ... };
+                (void)ignored;
+            }
+
+            template<typename Tup>
+            static void
+            push_back(type & cols, Tup && row)
+            {
+                int ignored[] = { (std::get<Is>(cols).push_back(std::get<Is>(std::forward<Tup>(row))), 0) ... };
+                (void)ignored;
+            }
+        };
+    }
+
+    template<size_t I>
+    struct unzip_tag_t{constexpr unzip_tag_t(){}};
+    template<size_t I>                  constexpr            unzip_tag_t<I>         unzip;    // no need for 'tagger_t', this directly runs
+    struct unzip_collect_tag_t{constexpr unzip_collect_tag_t(){}};
+                                        constexpr            unzip_collect_tag_t    unzip_collect;    // no need for 'tagger_t', this directly runs
+
+    template<typename R, size_t I
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> )
+            >
+    auto constexpr
+    operator| (R r, unzip_tag_t<I>)
+    { return std::move(r) |mapr| impl:: column_t<I>{}; }
+
+    template<typename R, size_t I
+            , typename Rnonref = std::remove_reference_t<R>
+            , SFINAE_ENABLE_IF_CHECK( !is_range_v<Rnonref> )
+            >
+    auto constexpr
+    operator| (R && nr, unzip_tag_t<I> tag)
+    ->decltype(as_range(std::forward<R>(nr)) | tag)
+    {   return as_range(std::forward<R>(nr)) | tag; }
+
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> )
+            >
+    auto
+    operator| (R r, unzip_collect_tag_t)
+    {
+        using columns = impl:: unzip_columns< std::decay_t<decltype(orange::front(r))> >;
+        typename columns:: type cols;
+        columns:: reserve(cols, orange:: size_hint(r));
+        while(!orange::empty(r))
+            columns:: push_back(cols, orange::pull(r));
+        return cols;
+    }
+
+    template<typename R
+            , typename Rnonref = std::remove_reference_t<R>
+            , SFINAE_ENABLE_IF_CHECK( !is_range_v<Rnonref> )
+            >
+    auto
+    operator| (R && nr, unzip_collect_tag_t tag)
+    ->decltype(as_range(std::forward<R>(nr)) | tag)
+    {   return as_range(std::forward<R>(nr)) | tag; }
+
     namespace testing_namespace {
         constexpr
         int apply_test() {
@@ -1697,6 +5602,36 @@ namespace orange {
         }
         static_assert(609 == apply_test(), "");
 
+        struct add_second_to_first_t {
+            constexpr add_second_to_first_t() {}
+            constexpr void operator() (int & x, int y) const { x += y; }
+        };
+        constexpr
+        int zip_columns_test() {
+            int a1[] = {300,200,100};
+            int a2[] = {3,2,1,0};
+
+            auto z = zip_columns(a1,a2);
+            int total = z |mapr| apply_pack % sum_all_args |accumulate;
+
+            zip_columns(a1,a2) |foreach| apply_pack % add_second_to_first_t{};
+            return total + a1[2] + std::get<1>(columns(z))[3];
+        }
+        static_assert(606 + 101 + 0 == zip_columns_test(), "");
+        static_assert(can_accumulate_integers_in_lanes< decltype(zip_columns(std::declval<int(&)[3]>(), std::declval<std::vector<int>&>()) |mapr| get_I_t<1>{}) > ,"");
+
+        // '|unzip<I>' of a 'zip_as_is' of lvalues refers into the column
+        constexpr
+        int unzip_test() {
+            int a1[] = {300,200,100};
+            int a2[] = {3,2,1};
+
+            zip_as_is(a1,a2) |unzip<1> |foreach| negate_me_in_place;
+            return (zip(a1,a2) |unzip<1> |accumulate) + (zip_columns(a1,a2) |unzip<0> |accumulate);
+        }
+        static_assert(-6 + 600 == unzip_test(), "");
+        static_assert(can_accumulate_integers_in_lanes< decltype(zip_columns(std::declval<int(&)[3]>(), std::declval<std::vector<int>&>()) |unzip<1>) > ,"");
+
         constexpr
         int
         replicate_test()
@@ -1715,5 +5650,185 @@ namespace orange {
         }
         static_assert(4242 == repeat_test() ,"");
 
+        constexpr int a1_for_slicing[] = {2,-3,5,-8,8};
+
+        static_assert(size_hint_is(size_hint_of( zip(ints(10), replicate(4, 'a'))          ), enum_size_hint::exact       , 4) ,"");
+        static_assert(size_hint_is(size_hint_of( zip(ints(10), ints(10) |filter| odd_t{})  ), enum_size_hint::upper_bound , 9) ,"");
+
+        template<typename R>
+        constexpr int
+        sum_of_slice(R r, size_t b, size_t e) { return orange:: slice(r, b, e) | accumulate; }
+
+        static_assert( is_sliceable_v< decltype( zip(ints(10), as_range(x)) ) > ,"");
+        static_assert(!is_sliceable_v< decltype( zip(ints(10), ints(10) |filter| odd_t{}) ) > ,"");
+        static_assert( 2+3+4        == sum_of_slice( ints(10)                                 , 2, 5) ,"");
+        static_assert( 3+5          == sum_of_slice( ints(10) |filter| odd_t{}                , 2, 5) ,""); // positions 2,3,4 of 1..9
+        static_assert( 2+3+4        == sum_of_slice( ints(10) |mapr| negate_t{} |mapr| negate_t{}, 2, 5) ,"");
+        static_assert( 5-8          == sum_of_slice( zip(a1_for_slicing, ints()) |mapr| get_I_t<0>{}, 2, 4) ,"");
+
+        // 'product' and 'product_tiled' have the same pairs, and are sliced by rows and bands of rows
+        static_assert( 3*(0+1+2+3)  == (product(ints(3), ints(4))                     |mapr| get_I_t<1>{} |accumulate) ,"");
+        static_assert( 3*(0+1+2+3)  == (product_tiled(ints(3), ints(4), 2, 3)         |mapr| get_I_t<1>{} |accumulate) ,"");
+        static_assert( 4*(1+2)      == (product(ints(3), ints(4))                     |mapr| get_I_t<0>{} |accumulate) ,"");
+        static_assert( 0            == (product(ints(3), ints(0))                     |mapr| get_I_t<0>{} |accumulate) ,"");
+        static_assert(size_hint_is(size_hint_of( product(ints(3), ints(4))             ), enum_size_hint::exact       , 12) ,"");
+        static_assert(size_hint_is(size_hint_of( product_tiled(ints(3), ints(4), 2, 2) ), enum_size_hint::exact       , 12) ,"");
+        static_assert( 4*2          == sum_of_slice( product(ints(3), ints(4))             |mapr| get_I_t<0>{}, 2, 3) ,"");
+        static_assert( 4*2          == sum_of_slice( product_tiled(ints(3), ints(4), 2, 2) |mapr| get_I_t<0>{}, 1, 2) ,"");
+
+        // the sizes known from the types, and '|collect_static'
+        static_assert(!has_static_size< decltype( ints(8)                                  ) > ,"");
+        static_assert( has_exact_static_size< decltype( ints<8>() |mapr| negate_t{}        ) > ,"");
+        static_assert(!has_exact_static_size< decltype( ints<8>() |filter| odd_t{}         ) > ,"");
+        static_assert( 8 == static_size_of< decltype( ints<8>() |filter| odd_t{}           ) >::value ,"");
+        static_assert( 3 == static_size_of< decltype( zip(ints<3>(), replicate<5>('x'))    ) >::value ,"");
+        static_assert(12 == static_size_of< decltype( product(ints<3>(), ints<4>())        ) >::value ,"");
+        static_assert( 4 == static_size_of< decltype( as_range(std::array<int,4>{{}})      ) >::value ,"");
+
+        struct square_t {
+            constexpr square_t() {}
+            constexpr int operator() (int x) const { return x*x; }
+        };
+        constexpr auto squares      = ints<8>() |mapr| square_t{} |collect_static;
+        static_assert(std::is_same< decltype(squares), std::array<int,8> const >{} ,"");
+        static_assert(49 == squares[7] && 9 == squares[3] ,"");
+        constexpr auto odd_squares  = ints<8>() |filter| odd_t{} |mapr| square_t{} |collect_static;
+        static_assert(std::is_same< decltype(odd_squares), static_vector<int,8> const >{} ,"");
+        static_assert( 4 == odd_squares.size() && 49 == odd_squares[3] ,"");
+        constexpr auto from_array   = std::array<int,3>{{1,2,3}} |collect_static;
+        static_assert( 3 == from_array[2] ,"");
+        static_assert(15 == (replicate<3>(5) |accumulate) ,"");
+        static_assert(-28 == (ints<8>() |mapr| negate_t{} |accumulate) ,"");
+        static_assert(-27 == (ints<8>() |mapr| negate_t{} |skip| 2 |accumulate) ,"");
+
+        // the ones that stop early. 'ints()' doesn't end
+        constexpr int some_ints[] = {5, -3, 9, 0, 2, 9, -3, 4, 1, 7};
+        static_assert(  7 == *(ints(100) |filter| odd_t{} |find_if| greater_than_5_t{}) ,"");
+        static_assert(!(ints(5) |find_if| greater_than_5_t{}).has_value() ,"");
+        static_assert(  9 == *(some_ints |find_if| greater_than_5_t{}) ,"");
+        static_assert(  (ints()   |any_of| greater_than_5_t{}) ,"");
+        static_assert( !(ints(6)  |any_of| greater_than_5_t{}) ,"");
+        static_assert( !(ints()   |all_of| odd_t{}) ,"");
+        static_assert(  (ints(10) |filter| odd_t{} |all_of| odd_t{}) ,"");
+        static_assert( -3 == (*(some_ints |min_max)).m_min && 9 == (*(some_ints |min_max)).m_max ,"");
+        static_assert(  7 == (*(ints(3,8) |min_max)).m_max ,"");
+        static_assert(!(ints(0) |min_max).has_value() ,"");
+
+        // 'memoize' no longer needs the heap, so it's fine in constexpr
+        static_assert( 45           == (ints(10)                            |memoize        |accumulate) ,"");
+        static_assert( 45           == (ints(10)                            |memoize_n<1>   |accumulate) ,"");
+        static_assert(-30           == (ints(10) |filter| greater_than_5_t{} |mapr| negate_t{}
+                                                                            |memoize_n<3>   |accumulate) ,"");
+        static_assert(  0           == (ints(0)                             |memoize_n<4>   |accumulate) ,"");
+
+        // batches, with each batch as a slice of the underlying range
+        template<typename R>
+        constexpr int
+        number_of_items_in(R r) {
+            int n = 0;
+            for(; !orange::empty(r); orange::advance(r))
+                ++n;
+            return n;
+        }
+        struct divide_by_3_t {
+            constexpr divide_by_3_t() {}
+            constexpr int operator() (int x) const { return x / 3; }
+        };
+        static_assert( 4            == number_of_items_in(ints(10)                  |chunk| 3           ) ,"");
+        static_assert( 1            == number_of_items_in(ints(10)                  |chunk| 10          ) ,"");
+        static_assert( 0            == number_of_items_in(ints(0)                   |chunk| 3           ) ,"");
+        static_assert( 4            == number_of_items_in(ints(10)                  |group_by| divide_by_3_t{}) ,"");
+        static_assert( 45           == (ints(10)                            |chunk| 3  |concat   |accumulate) ,"");
+        static_assert( 45           == (ints(10) |group_by| divide_by_3_t{}            |concat   |accumulate) ,"");
+
+        // 'merge' of sorted ranges is sorted, and has all their items
+        template<typename R>
+        constexpr bool
+        is_sorted_range(R r) {
+            if(orange::empty(r))
+                return true;
+            for(auto previous = orange::front(r); !orange::empty(r); orange::advance(r)) {
+                if(orange::front(r) < previous)
+                    return false;
+                previous = orange::front(r);
+            }
+            return true;
+        }
+        constexpr int a3_sorted[] = {-8, -3, 2, 5, 8};
+        constexpr int a4_sorted[] = {1, 1, 4};
+        static_assert( is_sorted_range(merge(a3_sorted, a4_sorted, ints(3))) ,"");
+        static_assert( 11           == number_of_items_in(merge(a3_sorted, a4_sorted, ints(3))) ,"");
+        static_assert( 4+6+3        == (merge(a3_sorted, a4_sorted, ints(3)) |accumulate) ,"");
+        static_assert( 2            == number_of_items_in(merge(ints(0), ints(2))) ,"");
+
+        // '|chunk' can be sliced by batch, for the parallel modes
+        template<typename R>
+        constexpr int
+        sum_of_batches_in_slice(R r, size_t b, size_t e) { return orange:: slice(r, b, e) |concat |accumulate; }
+        static_assert( 4+5+6+7      == sum_of_batches_in_slice( ints(10) |chunk| 2 , 2, 4) ,"");
+        static_assert( 9            == sum_of_batches_in_slice( ints(10) |chunk| 3 , 3, 4) ,"");
+        static_assert(std::is_same< std::decay_t<decltype(orange::front(std::declval< decltype(ints(10) |chunk| 3) &>()))>
+                                  , decltype(ints(10)) >{} ,"");
+
+        // '|mapr|' and '|take|' keep the random access of what they're given, and
+        // so '|skip|' over them is O(1)
+        template<typename R>
+        constexpr auto
+        distance_from_begin_to_end(R r) { return orange::end(r) - orange::begin(r); }
+        template<typename R>
+        constexpr auto
+        front_at_of(R r, size_t i) { return orange::front_at(r, i); }
+        static_assert( has_trait_advance_n< decltype( as_range(a1_for_slicing) |mapr| negate_t{} |take| 3 )& > ,"");
+        static_assert(!has_trait_advance_n< decltype( ints(10) |filter| odd_t{}                  )& > ,"");
+        static_assert( 5+6+7        == (ints(10) |skip| 5 |take| 3                          |accumulate) ,"");
+        static_assert( 5+7+9        == (ints(10) |filter| odd_t{} |skip| 2                  |accumulate) ,"");
+        static_assert(size_hint_is(size_hint_of( ints(10) |skip| 7 |take| 5              ), enum_size_hint::exact       , 3) ,"");
+        static_assert(size_hint_is(size_hint_of( ints(10) |filter| odd_t{} |take| 3      ), enum_size_hint::upper_bound , 3) ,"");
+        static_assert( 2+3          == sum_of_slice( ints(10) |take| 4                      , 2, 4) ,"");
+        static_assert( is_sliceable_v< decltype( ints(10) |mapr| negate_t{} |take| 3 ) >    ,"");
+        static_assert(!is_sliceable_v< decltype( ints(10) |filter| odd_t{} |take| 3 ) >     ,""); // the positions aren't the items
+        static_assert( 8            == front_at_of( as_range(a1_for_slicing) |mapr| negate_t{} |skip| 1, 2) ,"");
+        static_assert( 5            == distance_from_begin_to_end( as_range(a1_for_slicing) |mapr| negate_t{} ) ,"");
+        static_assert( 2            == distance_from_begin_to_end( as_range(a1_for_slicing) |take| 2 ) ,"");
+
+        // range-based for works on every range, with synthesized iterators where
+        // the range has no 'begin' and 'end' of its own
+        template<typename R>
+        constexpr int
+        sum_by_range_for(R r) { int total = 0; for(auto x : r) total += x; return total; }
+        static_assert( 1+3+5+7+9    == sum_by_range_for( ints(10) |filter| odd_t{} ) ,"");
+        static_assert(-(2-3+5-8+8)  == sum_by_range_for( as_range(a1_for_slicing) |mapr| negate_t{} ) ,"");
+        static_assert( 8            == sum_by_range_for( zip(a1_for_slicing |filter| greater_than_5_t{}, ints()) |mapr| get_I_t<0>{} ) ,"");
+
+        // '|scan|' gives the running totals, and an 'accumulator' can be fed
+        // more later, or merged with another
+        static_assert( 0+1+3+6+10   == (ints(5) |scan| std::plus<>{}                       |accumulate) ,"");
+        static_assert( 0            == (ints(0) |scan| std::plus<>{}                       |accumulate) ,"");
+        static_assert(size_hint_is(size_hint_of( ints(5) |scan| std::plus<>{} ), enum_size_hint::exact, 5) ,"");
+        constexpr accumulator<int>
+        fed_in_two_parts() { return make_accumulator(0).feed(ints(4)).feed(ints(4,10)); }
+        constexpr accumulator<int>
+        merged_from_two_shards() { auto a = make_accumulator(0).feed(ints(4)); a.merge(make_accumulator(0).feed(ints(4,10))); return a; }
+        static_assert( 45 == fed_in_two_parts().total()         && 10 == fed_in_two_parts().count()          ,"");
+        static_assert( 45 == merged_from_two_shards().total()   && 10 == merged_from_two_shards().count()    ,"");
+        static_assert( 45 == accumulator<int>{ make_accumulator(0).feed(ints(4)).state() }.feed(ints(4,10)).total() ,"");
+
+        // '|accumulate' over integers uses several accumulators where it can
+        constexpr int a2_for_lanes[] = {1,10,100,1000,10000};
+        static_assert( can_accumulate_integers_in_lanes< decltype( ints(10)                               ) > ,"");
+        static_assert( can_accumulate_integers_in_lanes< decltype( as_range(a1_for_slicing)               ) > ,"");
+        static_assert( can_accumulate_integers_in_lanes< decltype( ints(10) |filter| odd_t{} |mapr| negate_t{}) > ,"");
+        static_assert( can_accumulate_integers_in_lanes< decltype( zip(a1_for_slicing, a2_for_lanes) |mapr| get_I_t<1>{}) > ,"");
+        static_assert(!can_accumulate_integers_in_lanes< decltype( as_range(x)                            ) > ,""); // double
+        static_assert( can_accumulate_in_lanes         < decltype( as_range(x)                            ) > ,"");
+        static_assert(!has_lanes< decltype( zip(ints(10) |filter| odd_t{}, ints())                        ) > ,"");
+        static_assert( 10+1000      == (zip(a1_for_slicing, a2_for_lanes)
+                                            |filter|    compose(less_than_this{0}, get_I_t<0>{})
+                                            |mapr|      get_I_t<1>{}
+                                            |accumulate) ,"");
+        static_assert(-(1+3+5+7+9+11+13+15+17+19) == (ints(20) |filter| odd_t{} |mapr| negate_t{} |accumulate) ,"");
+        static_assert( 45           == (ints(10) |accumulate_in_lanes) ,"");
     }
 } // namespace orange
+
+#endif
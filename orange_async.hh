@@ -0,0 +1,467 @@
+/*
+ * orange_async  - overlapping a slow source with the rest of the pipeline
+ *
+ * This is kept separate from orange.hh, as it needs <thread>, and
+ * <coroutine> for 'generator'.
+ *
+ *      std::ifstream f("big.log");
+ *      range::from::owning_lines(f)
+ *          |prefetch|  1024
+ *          |mapr|      parse_record
+ *          |foreach|   [&](record const & r) { ... };
+ *
+ * '|prefetch| n' moves its range into a background thread, which reads up
+ * to 'n' items ahead into a ring buffer. The pipeline after it takes the
+ * items from the ring, so the parsing here overlaps with the reading
+ * instead of waiting for it. It's for sources that block, on a disk or a
+ * socket. For anything that's already in memory, it just adds the cost of
+ * handing each item between threads.
+ *
+ * The items are copied (or moved) into the ring, as the decayed type of
+ * 'front'. So a source whose 'front' refers into its own buffer, such as
+ * the 'line_view's of 'range::from::lines', must be made to own its
+ * items before '|prefetch|', with 'owning_lines' or a '|mapr|'.
+ *
+ * An exception thrown by the source in the background thread is caught,
+ * and thrown again from 'empty' once the items before it have been taken.
+ * If the range is destroyed before the end, the thread is stopped as soon
+ * as it next puts an item into the ring, and joined. If the source is
+ * blocked in a read, the destructor waits for that read.
+ *
+ * A 'channel<T>' hands items from one thread's pipeline to another's, with
+ * an output range at one end and an ordinary range at the other. See below.
+ *
+ * With C++20 coroutines, 'generator<T>' is a range whose items are
+ * 'co_yield'ed by a coroutine:
+ *
+ *      orange:: generator<int> evens(int n) {
+ *          for(int i = 0; i<n; i+=2)
+ *              co_yield i;
+ *      }
+ *
+ *      evens(10) |mapr| [](int x) { return x*x; } |accumulate;
+ */
+
+#ifndef AMD_ORANGE_ASYNC_HH
+#define AMD_ORANGE_ASYNC_HH
+
+#include "orange.hh"
+
+#include<atomic>
+#include<condition_variable>
+#include<exception>
+#include<memory>
+#include<mutex>
+#include<thread>
+#include<vector>
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#include<coroutine>
+#define ORANGE_HAS_COROUTINES 1
+#else
+#define ORANGE_HAS_COROUTINES 0
+#endif
+
+namespace orange {
+
+    namespace impl {
+        /*  spsc_ring<T>
+         *  ============
+         *      A bounded ring for one producer thread and one consumer thread.
+         *  'm_head' is written only by the consumer and 'm_tail' only by the
+         *  producer, so neither needs a lock to move along.
+         *      Each side works on its own copy of its index, and publishes it
+         *  only every 'm_batch' items, and keeps a copy of the other side's
+         *  index that it reloads only when it seems to have run out. So with
+         *  a batch of 64, the cache lines that hold the indices move between
+         *  the cores about once per 64 items instead of once per item.
+         *      A side only locks the mutex when it has to sleep (the ring full,
+         *  or empty), after a short spin, and it publishes everything first.
+         *  The other side takes the mutex to wake it only if 'm_sleepers' says
+         *  that someone may be sleeping.
+         */
+        template<typename T>
+        class spsc_ring {
+            std:: vector<orange_utils:: optional_value<T>>  m_slots;
+            size_t const                m_batch;
+
+            alignas(64)
+            std:: atomic<size_t>        m_head      {0};    // the next to be taken, as published
+            std:: atomic<bool>          m_cancelled {false};// the consumer has gone
+            size_t                      m_head_own  = 0;    // the consumer's own
+            size_t                      m_tail_seen = 0;    // the consumer's copy of 'm_tail'
+
+            alignas(64)
+            std:: atomic<size_t>        m_tail      {0};    // the next to be filled, as published
+            std:: atomic<bool>          m_closed    {false};// the producer is finished
+            std:: exception_ptr         m_error;            // set before 'm_closed'
+            size_t                      m_tail_own  = 0;    // the producer's own
+            size_t                      m_head_seen = 0;    // the producer's copy of 'm_head'
+
+            alignas(64)
+            std:: mutex                 m_mutex;
+            std:: condition_variable    m_wake;
+            std:: atomic<int>           m_sleepers  {0};
+
+            template<typename Ready>
+            void
+            wait_until(Ready ready) {
+                for(int spin = 0; spin < 64; ++spin)
+                    if(ready())
+                        return;
+                std:: unique_lock<std::mutex> lock(m_mutex);
+                ++m_sleepers;
+                m_wake.wait(lock, ready);
+                --m_sleepers;
+            }
+            void
+            wake() {
+                if(m_sleepers.load() != 0) {
+                    std:: lock_guard<std::mutex> lock(m_mutex);
+                    m_wake.notify_all();
+                }
+            }
+
+            size_t  capacity()  const { return m_slots.size(); }
+
+            void    publish_tail()  { m_tail.store(m_tail_own); wake(); }
+            void    publish_head()  { m_head.store(m_head_own); wake(); }
+
+        public:
+            // the batch is at most a quarter of the capacity, so that neither side waits long for the other's
+            explicit spsc_ring(size_t capacity, size_t batch = 1)
+            : m_slots(capacity > 0 ? capacity : 1)
+            , m_batch( std:: max<size_t>(1, std:: min(batch, m_slots.size() / 4)) )
+            {}
+
+            // the producer's side. 'false' means the consumer has gone
+            template<typename U>
+            bool
+            push(U && u) {
+                if(m_tail_own - m_head_seen == capacity())
+                    m_head_seen = m_head.load();
+                if(m_tail_own - m_head_seen == capacity()) {
+                    publish_tail();
+                    wait_until([&]{ return m_tail_own - m_head.load() < capacity() || m_cancelled.load(); });
+                    m_head_seen = m_head.load();
+                }
+                if(m_cancelled.load(std::memory_order_relaxed))
+                    return false;
+                m_slots[m_tail_own % capacity()].emplace(std::forward<U>(u));
+                ++m_tail_own;
+                if(m_tail_own - m_tail.load(std::memory_order_relaxed) >= m_batch)
+                    publish_tail();
+                return true;
+            }
+            void
+            close(std:: exception_ptr error = nullptr) {
+                m_error = error;
+                m_tail.store(m_tail_own);
+                m_closed.store(true);
+                wake();
+            }
+            bool
+            cancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+
+            // the consumer's side
+            bool
+            empty() {
+                if(m_head_own != m_tail_seen)
+                    return false;
+                m_tail_seen = m_tail.load();
+                if(m_head_own != m_tail_seen)
+                    return false;
+                publish_head();
+                wait_until([&]{ return m_tail.load() != m_head_own || m_closed.load(); });
+                m_tail_seen = m_tail.load();
+                if(m_head_own != m_tail_seen)
+                    return false;
+                if(m_error) {
+                    std:: exception_ptr error = m_error;
+                    m_error = nullptr;
+                    std:: rethrow_exception(error);
+                }
+                return true;
+            }
+            // these wait for the item if 'empty' wasn't called first
+            T &
+            front() {
+                if(m_head_own == m_tail_seen) {
+                    bool const was_empty = empty();
+                    assert(!was_empty); (void)was_empty;
+                }
+                return *m_slots[m_head_own % capacity()];
+            }
+            void
+            pop() {
+                if(m_head_own == m_tail_seen) {
+                    bool const was_empty = empty();
+                    assert(!was_empty); (void)was_empty;
+                }
+                m_slots[m_head_own % capacity()].reset();
+                ++m_head_own;
+                if(m_head_own - m_head.load(std::memory_order_relaxed) >= m_batch)
+                    publish_head();
+            }
+            void
+            cancel() {
+                m_cancelled.store(true);
+                wake();
+            }
+        };
+    }
+
+    /*  prefetch_range<R>
+     *  =================
+     *      The ring is on the heap, so that it stays put for the producer
+     *  thread while the range is moved.
+     */
+    template<typename R>
+    struct prefetch_range
+    {
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+        static_assert(!std::is_reference<R>{},"");
+        static_assert( is_range_v<R>, "");
+
+        using value_type = std::decay_t<decltype(orange::front(std::declval<R&>()))>;
+
+        std:: unique_ptr<impl:: spsc_ring<value_type>>  m_ring;
+        std:: thread                                    m_producer;
+
+        prefetch_range(R r, size_t n)
+        : m_ring(std:: make_unique<impl:: spsc_ring<value_type>>(n))
+        , m_producer(produce, m_ring.get(), std::move(r))
+        {}
+
+        prefetch_range(prefetch_range &&)               = default;
+        prefetch_range& operator=(prefetch_range &&)    = delete;   // it would have to stop the thread it replaces
+
+        ~prefetch_range() {
+            if(m_producer.joinable()) {
+                m_ring->cancel();
+                m_producer.join();
+            }
+        }
+
+        static void
+        produce(impl:: spsc_ring<value_type> * ring, R r) {
+            try {
+                for(; !orange::empty(r); orange::advance(r))
+                    if(!ring->push(orange::front(r)))
+                        break;
+                ring->close();
+            } catch(...) {
+                ring->close(std:: current_exception());
+            }
+        }
+
+        template<typename M> static bool
+        orange_empty      (M &m) { return m.m_ring->empty(); }
+        template<typename M> static value_type &
+        orange_front      (M &m) { return m.m_ring->front(); }
+        template<typename M> static void
+        orange_advance    (M &m) { m.m_ring->pop(); }
+    };
+
+    /*  |prefetch| n
+     *  ============
+     *      'n' is how many items the background thread may read ahead.
+     */
+    struct prefetch_tag_t       {};     constexpr   tagger_t<prefetch_tag_t     >   prefetch;
+
+    template<typename R>
+    auto
+    operator| (forward_this_with_a_tag<R,prefetch_tag_t> f, size_t n)
+    { return prefetch_range<R>{ std::move(f.m_r), n }; }
+
+    /*  channel<T>
+     *  ==========
+     *      A bounded queue between two stages that run in different threads,
+     *  for pipelines that can't be split by data, such as those with a
+     *  stateful stage. One thread writes to the 'writer()', an output range
+     *  with 'push' and 'full', and one thread reads the 'reader()', which is
+     *  an ordinary range. Each end can be taken once, as the ring is for one
+     *  producer and one consumer; for more, use more channels.
+     *
+     *      orange:: channel<record> ch(4096);
+     *      std:: thread parsing( [w = ch.writer()]() mutable {
+     *          lines |mapr| parse |copy_to| w;
+     *      });
+     *      ch.reader() |memoize |filter| keep |foreach| sink;
+     *      parsing.join();
+     *
+     *      The items are handed over 'batch' at a time (64 by default). The
+     *  writer publishes them when a batch is complete, or the ring is full,
+     *  or it's closed by 'close()' or by its destructor. So the reader sees
+     *  nothing of a batch until then. For a trickle of items that must each
+     *  be seen at once, use a batch of 1.
+     *
+     *      Once the reader is destroyed, 'full(writer)' is true and more
+     *  pushes are dropped, so the writing thread can stop early. The writer
+     *  can pass an exception, with 'close(std::current_exception())', to be
+     *  thrown from the reader's 'empty' after the items before it. If the
+     *  writer is never taken, the channel closes it when it's destroyed.
+     */
+    template<typename T>
+    class channel_writer {
+        std:: shared_ptr<impl:: spsc_ring<T>>   m_ring;
+
+    public:
+        explicit channel_writer(std:: shared_ptr<impl:: spsc_ring<T>> ring) : m_ring(std::move(ring)) {}
+
+        channel_writer(channel_writer &&)               = default;
+        channel_writer& operator=(channel_writer && other) {
+            if(this != &other) {
+                close();
+                m_ring = std::move(other.m_ring);
+            }
+            return *this;
+        }
+        ~channel_writer() { close(); }
+
+        void
+        close(std:: exception_ptr error = nullptr) {
+            if(m_ring) {
+                m_ring->close(error);
+                m_ring.reset();
+            }
+        }
+
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+
+        template<typename M> static bool
+        orange_full       (M &m) { return !m.m_ring || m.m_ring->cancelled(); }
+        template<typename M, typename U
+                , SFINAE_ENABLE_IF_CHECK( std::is_constructible<T, U&&>{} )
+                > static void
+        orange_push       (M &m, U && u) {
+            assert(m.m_ring);
+            m.m_ring->push(std::forward<U>(u));
+        }
+    };
+
+    template<typename T>
+    class channel_reader {
+        std:: shared_ptr<impl:: spsc_ring<T>>   m_ring;
+
+    public:
+        explicit channel_reader(std:: shared_ptr<impl:: spsc_ring<T>> ring) : m_ring(std::move(ring)) {}
+
+        channel_reader(channel_reader &&)               = default;
+        channel_reader& operator=(channel_reader && other) {
+            if(this != &other) {
+                if(m_ring) m_ring->cancel();
+                m_ring = std::move(other.m_ring);
+            }
+            return *this;
+        }
+        ~channel_reader() { if(m_ring) m_ring->cancel(); }
+
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+
+        template<typename M> static bool
+        orange_empty      (M &m) { return m.m_ring->empty(); }
+        template<typename M> static T &
+        orange_front      (M &m) { return m.m_ring->front(); }
+        template<typename M> static void
+        orange_advance    (M &m) { m.m_ring->pop(); }
+    };
+
+    template<typename T>
+    class channel {
+        std:: shared_ptr<impl:: spsc_ring<T>>   m_ring;
+        bool                                    m_writer_taken = false;
+        bool                                    m_reader_taken = false;
+
+    public:
+        explicit channel(size_t capacity, size_t batch = 64)
+        : m_ring(std:: make_shared<impl:: spsc_ring<T>>(capacity, batch)) {}
+
+        channel(channel &&)                 = default;
+        channel& operator=(channel &&)      = delete;
+        ~channel() { if(m_ring && !m_writer_taken) m_ring->close(); }
+
+        channel_writer<T>
+        writer() {
+            assert(!m_writer_taken);
+            m_writer_taken = true;
+            return channel_writer<T>{ m_ring };
+        }
+        channel_reader<T>
+        reader() {
+            assert(!m_reader_taken);
+            m_reader_taken = true;
+            return channel_reader<T>{ m_ring };
+        }
+    };
+
+#if ORANGE_HAS_COROUTINES
+    /*  generator<T>
+     *  ============
+     *      The coroutine doesn't start until the range is first used. Each
+     *  'co_yield' stores its item in the promise, where 'front' refers to it
+     *  until the next 'advance' resumes the coroutine. An exception from the
+     *  coroutine is thrown from the 'empty' or 'advance' that resumed it.
+     */
+    template<typename T>
+    class generator {
+        static_assert(!std::is_reference<T>{},"");
+    public:
+        struct promise_type {
+            orange_utils:: optional_value<T>    m_current;
+            std:: exception_ptr                 m_error;
+
+            generator               get_return_object() { return generator{ std:: coroutine_handle<promise_type>:: from_promise(*this) }; }
+            std:: suspend_always    initial_suspend()   noexcept { return {}; }
+            std:: suspend_always    final_suspend()     noexcept { return {}; }
+            template<typename U>
+            std:: suspend_always    yield_value(U && u) { m_current.emplace(std::forward<U>(u)); return {}; }
+            void                    return_void()       {}
+            void                    unhandled_exception() { m_error = std:: current_exception(); }
+        };
+
+    private:
+        std:: coroutine_handle<promise_type>    m_h;
+        mutable bool                            m_started = false;
+
+        explicit generator(std:: coroutine_handle<promise_type> h) : m_h(h) {}
+
+        void
+        resume() const {
+            m_h.resume();
+            if(m_h.promise().m_error)
+                std:: rethrow_exception(std:: exchange(m_h.promise().m_error, nullptr));
+        }
+        void
+        start() const {
+            if(!m_started) {
+                m_started = true;
+                resume();
+            }
+        }
+
+    public:
+        generator(generator && other) noexcept : m_h(std:: exchange(other.m_h, nullptr)), m_started(other.m_started) {}
+        generator& operator=(generator && other) noexcept {
+            if(this != &other) {
+                if(m_h) m_h.destroy();
+                m_h         = std:: exchange(other.m_h, nullptr);
+                m_started   = other.m_started;
+            }
+            return *this;
+        }
+        ~generator() { if(m_h) m_h.destroy(); }
+
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+
+        template<typename M> static bool
+        orange_empty      (M &m) { m.start(); return m.m_h.done(); }
+        template<typename M> static T &
+        orange_front      (M &m) { m.start(); return *m.m_h.promise().m_current; }
+        template<typename M> static void
+        orange_advance    (M &m) { m.start(); m.resume(); }
+    };
+#endif
+}
+
+#endif
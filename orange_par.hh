@@ -0,0 +1,549 @@
+/*
+ * orange_par  - parallel execution for orange ranges
+ *
+ * This is kept separate from orange.hh, as it needs <thread>.
+ *
+ *      vector<double> v = ...;
+ *
+ *      // sum of squares, using all the cores
+ *      v   |mapr|          [](double x) { return x*x; }
+ *          |par_accumulate;
+ *
+ *      // call a function for every item. The function may be called
+ *      // from many threads at once, so it must be safe to do so.
+ *      v   |filter|        [](double x) { return x > 0; }
+ *          |par_foreach|   [&](double x) { counter += x; };
+ *
+ *      // the first positive item, if there's one. Once one is found, the
+ *      // pieces that come after it are skipped
+ *      v   |par_find_if|   [](double x) { return x > 0; };
+ *      v   |par_any_of|    [](double x) { return x > 0; };
+ *      v   |par_all_of|    [](double x) { return x > 0; };
+ *
+ *      // pieces of at most 1000 positions, run on our own pool
+ *      orange:: thread_pool pool(8);
+ *      v   |par_accumulate.grain(1000).on(pool);
+ *      v   |par_foreach.grain(1000).on(pool)|  [&](double x) { ... };
+ *
+ * The range is split in half recursively with 'orange::slice' (see
+ * orange.hh), until the pieces are no longer than the 'grain'. Each piece
+ * runs the ordinary single-threaded pipeline. The halves are handed to a
+ * work-stealing 'thread_pool', so if some pieces are much more expensive
+ * than others (an expensive '|filter|' predicate on some records, say),
+ * the idle threads will steal the remaining work.
+ *
+ * For '|par_accumulate', the partial totals are added together following
+ * the same tree as the splitting. That depends only on the length and the
+ * grain, so the answer is the same from run to run, even with floating
+ * point. But it may differ slightly from '|accumulate'.
+ *
+ * For '|par_find_if|', each piece that finds a match records where it
+ * starts, if that's earlier than the match that's already there. Pieces
+ * that start after it are then skipped, without being searched or split.
+ * So the answer is the same as '|find_if|'. '|par_any_of|' and
+ * '|par_all_of|' skip all the remaining pieces once the answer is known.
+ *
+ * A range is split only if 'is_sliceable_v' is true. That covers ranges
+ * like 'ints(l,u)', vectors, C arrays and 'zip', and the '|mapr|' and
+ * '|filter|' of those. Any other range is run as if '|accumulate' or
+ * '|foreach|' had been used instead.
+ */
+
+#ifndef AMD_ORANGE_PAR_HH
+#define AMD_ORANGE_PAR_HH
+
+#include "orange.hh"
+
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+#include<atomic>
+#include<deque>
+#include<vector>
+#include<memory>
+#include<exception>
+#include<limits>
+
+namespace orange {
+
+    /*  thread_pool
+     *  ===========
+     *      A small work-stealing pool. Each worker has its own queue of tasks.
+     *  A worker takes the newest task from its own queue and, when that's
+     *  empty, steals the oldest task from another queue. Threads that aren't
+     *  in the pool share one extra queue.
+     *
+     *      The only way to give it work is 'fork_join(left, right)', which
+     *  runs both and returns when both are finished. 'right' is put on the
+     *  queue for others to steal while this thread runs 'left'; then, until
+     *  'right' is finished, this thread runs other queued tasks rather than
+     *  sitting idle.
+     *
+     *      The threads are started once, in the constructor, and can be used
+     *  by any number of calls. 'default_thread_pool()' is shared by all the
+     *  '|par_*' operations that don't name a pool.
+     */
+    class thread_pool {
+
+        struct task {
+            std:: atomic<bool>  m_done {false};
+            std:: exception_ptr m_error;
+
+            virtual void run() = 0;
+            virtual ~task() = default;
+        };
+
+        template<typename F>
+        struct task_for : public task {
+            F & m_f;
+            task_for(F & f) : m_f(f) {}
+            void run() override { m_f(); }
+        };
+
+        struct queue {
+            std:: mutex         m_mutex;
+            std:: deque<task*>  m_tasks;
+        };
+
+        struct identity {
+            thread_pool const * m_pool;
+            size_t              m_queue;
+        };
+
+        static
+        identity &
+        this_thread_identity() {
+            static thread_local identity id {nullptr, 0};
+            return id;
+        }
+
+        std:: vector<std::unique_ptr<queue>>    m_queues;   // [0] is for threads outside the pool
+        std:: vector<std::thread>               m_workers;
+        std:: atomic<size_t>                    m_queued {0};
+        std:: atomic<bool>                      m_stop {false};
+        std:: mutex                             m_sleep_mutex;
+        std:: condition_variable                m_wake;
+
+        size_t
+        my_queue() const {
+            identity & id = this_thread_identity();
+            return id.m_pool == this ? id.m_queue : 0;
+        }
+
+        void
+        push(size_t q, task * t) {
+            {
+                std:: lock_guard<std::mutex> lk(m_queues[q]->m_mutex);
+                m_queues[q]->m_tasks.push_back(t);
+                ++m_queued;
+            }
+            { std:: lock_guard<std::mutex> lk(m_sleep_mutex); }
+            m_wake.notify_one();
+        }
+
+        // the newest from our own queue, otherwise the oldest from any other queue
+        task *
+        find_task(size_t q) {
+            {
+                std:: lock_guard<std::mutex> lk(m_queues[q]->m_mutex);
+                auto & tasks = m_queues[q]->m_tasks;
+                if(!tasks.empty()) {
+                    task * t = tasks.back();
+                    tasks.pop_back();
+                    --m_queued;
+                    return t;
+                }
+            }
+            for(size_t i = 1; i<m_queues.size(); ++i) {
+                auto & victim = *m_queues[(q+i) % m_queues.size()];
+                std:: lock_guard<std::mutex> lk(victim.m_mutex);
+                if(!victim.m_tasks.empty()) {
+                    task * t = victim.m_tasks.front();
+                    victim.m_tasks.pop_front();
+                    --m_queued;
+                    return t;
+                }
+            }
+            return nullptr;
+        }
+
+        static
+        void
+        run(task * t) {
+            try { t->run(); }
+            catch(...) { t->m_error = std::current_exception(); }
+            t->m_done.store(true, std::memory_order_release);
+        }
+
+        void
+        worker_loop(size_t q) {
+            this_thread_identity() = identity{this, q};
+            while(!m_stop) {
+                if(task * t = find_task(q)) {
+                    run(t);
+                    continue;
+                }
+                std:: unique_lock<std::mutex> lk(m_sleep_mutex);
+                m_wake.wait(lk, [this](){ return m_stop || m_queued > 0; });
+            }
+        }
+
+    public:
+        explicit
+        thread_pool(size_t number_of_workers)
+        {
+            for(size_t q = 0; q <= number_of_workers; ++q)
+                m_queues.push_back(std::make_unique<queue>());
+            for(size_t w = 0; w < number_of_workers; ++w)
+                m_workers.emplace_back([this,w](){ this->worker_loop(w+1); });
+        }
+
+        // one worker per core, less one for the thread that calls 'fork_join'
+        thread_pool()
+        : thread_pool( std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0 )
+        {}
+
+        thread_pool             (thread_pool const &) = delete;
+        thread_pool & operator= (thread_pool const &) = delete;
+
+        ~thread_pool() {
+            {
+                std:: lock_guard<std::mutex> lk(m_sleep_mutex);
+                m_stop = true;
+            }
+            m_wake.notify_all();
+            for(auto & w : m_workers)
+                w.join();
+        }
+
+        // how many threads can run at once: the workers, and the caller
+        size_t
+        concurrency() const { return m_workers.size() + 1; }
+
+        template<typename L, typename R>
+        void
+        fork_join(L && left, R && right) {
+            if(m_workers.empty()) {
+                left();
+                right();
+                return;
+            }
+
+            task_for<std::remove_reference_t<R>> right_task(right);
+            size_t q = my_queue();
+            push(q, &right_task);
+
+            std:: exception_ptr left_error;
+            try { left(); }
+            catch(...) { left_error = std::current_exception(); }
+
+            // 'right_task' is on our stack, so we must wait for it even if 'left' threw
+            while(!right_task.m_done.load(std::memory_order_acquire)) {
+                if(task * t = find_task(q))
+                    run(t);
+                else
+                    std:: this_thread:: yield();
+            }
+
+            if(left_error)
+                std:: rethrow_exception(left_error);
+            if(right_task.m_error)
+                std:: rethrow_exception(right_task.m_error);
+        }
+    };
+
+    inline
+    thread_pool &
+    default_thread_pool() {
+        static thread_pool pool;
+        return pool;
+    }
+
+
+    /*  par_tag_t
+     *  =========
+     *      The type of 'par_accumulate', 'par_foreach' and the others. They carry the
+     *  (optional) pool and grain, which can be changed with '.on(pool)' and
+     *  '.grain(n)'.
+     */
+    struct par_accumulate_tag_t {};
+    struct par_foreach_tag_t    {};
+    struct par_find_if_tag_t    {};
+    struct par_any_of_tag_t     {};
+    struct par_all_of_tag_t     {};
+
+    template<typename Tag_type>
+    struct par_tag_t {
+        thread_pool *   m_pool  = nullptr;  // nullptr means 'default_thread_pool()'
+        size_t          m_grain = 0;        // 0 means we choose, based on the length and the pool
+
+        constexpr par_tag_t() {} // clang-3.8.0 insists on a user-provided default constructor
+        constexpr par_tag_t(thread_pool * pool, size_t grain) : m_pool(pool), m_grain(grain) {}
+
+        constexpr par_tag_t grain   (size_t how_many)   const { return {m_pool, how_many}; }
+        constexpr par_tag_t on      (thread_pool & pool)const { return {&pool, m_grain}; }
+
+        thread_pool &
+        pool() const { return m_pool ? *m_pool : default_thread_pool(); }
+
+        // about eight pieces per thread, so there's something left to steal
+        size_t
+        grain_for(size_t n, thread_pool const & pool) const {
+            if(m_grain > 0)
+                return m_grain;
+            size_t g = n / (8 * pool.concurrency());
+            return g > 0 ? g : 1;
+        }
+    };
+
+    constexpr   par_tag_t<par_accumulate_tag_t> par_accumulate;     // this directly runs
+    constexpr   par_tag_t<par_foreach_tag_t   > par_foreach;
+    constexpr   par_tag_t<par_find_if_tag_t   > par_find_if;
+    constexpr   par_tag_t<par_any_of_tag_t    > par_any_of;
+    constexpr   par_tag_t<par_all_of_tag_t    > par_all_of;
+
+    // as with 'forward_this_with_a_tag', this captures the left-hand '|' of  (x|par_foreach|func)
+    template<typename R, typename Tag_type>
+    struct forward_this_with_a_par_tag {
+        R m_r;
+        par_tag_t<Tag_type> m_tag;
+        static_assert(!std:: is_reference<R>{}, "");
+        static_assert( is_range_v< R >, "");
+    };
+
+    namespace impl {
+        /*  accumulate_slices, foreach_slices
+         *  =================================
+         *      Split positions [b,e) of 'r' in half, recursively, down to the
+         *  grain. Each half may be stolen by another thread. 'r' itself is
+         *  only read, to make the slices, so it can be shared by all the threads.
+         */
+        template<typename V, typename R>
+        V
+        accumulate_slices(thread_pool & pool, R & r, size_t b, size_t e, size_t grain)
+        {
+            if(e - b <= grain)
+                return orange::slice(r, b, e) | accumulate;
+
+            size_t mid = b + (e - b) / 2;
+            V left_total    = 0;
+            V right_total   = 0;
+            pool.fork_join  ( [&](){ left_total  = accumulate_slices<V>(pool, r, b  , mid, grain); }
+                            , [&](){ right_total = accumulate_slices<V>(pool, r, mid, e  , grain); }
+                            );
+            left_total += right_total;
+            return left_total;
+        }
+
+        template<typename R, typename Func>
+        void
+        foreach_slices(thread_pool & pool, R & r, size_t b, size_t e, size_t grain, Func & func)
+        {
+            if(e - b <= grain) {
+                orange::slice(r, b, e) |foreach| func;
+                return;
+            }
+
+            size_t mid = b + (e - b) / 2;
+            pool.fork_join  ( [&](){ foreach_slices(pool, r, b  , mid, grain, func); }
+                            , [&](){ foreach_slices(pool, r, mid, e  , grain, func); }
+                            );
+        }
+
+        /*  find_in_slices, any_in_slices
+         *  =============================
+         *      As above, but a piece isn't searched, or split, if an earlier
+         *  piece has a match ('find_in_slices') or any piece has
+         *  ('any_in_slices').
+         */
+        template<typename V>
+        struct first_found {
+            std:: atomic<size_t>    m_start {std::numeric_limits<size_t>::max()};  // of the earliest piece with a match
+            std:: mutex             m_mutex;
+            V                       m_value;    // an 'optional_value'
+
+            template<typename X>
+            void
+            offer(size_t start, X && x) {
+                std:: lock_guard<std::mutex> lk(m_mutex);
+                if(start < m_start.load(std::memory_order_relaxed)) {
+                    m_start.store(start, std::memory_order_relaxed);
+                    m_value.emplace(std::forward<X>(x));
+                }
+            }
+        };
+
+        template<typename R, typename P, typename V>
+        void
+        find_in_slices(thread_pool & pool, R & r, size_t b, size_t e, size_t grain, P & p, first_found<V> & found)
+        {
+            if(found.m_start.load(std::memory_order_relaxed) < b)
+                return;
+            if(e - b <= grain) {
+                auto x = orange::slice(r, b, e) |find_if| p;
+                if(x.has_value())
+                    found.offer(b, std::move(*x));
+                return;
+            }
+
+            size_t mid = b + (e - b) / 2;
+            pool.fork_join  ( [&](){ find_in_slices(pool, r, b  , mid, grain, p, found); }
+                            , [&](){ find_in_slices(pool, r, mid, e  , grain, p, found); }
+                            );
+        }
+
+        template<typename R, typename P>
+        void
+        any_in_slices(thread_pool & pool, R & r, size_t b, size_t e, size_t grain, P & p, std::atomic<bool> & found)
+        {
+            if(found.load(std::memory_order_relaxed))
+                return;
+            if(e - b <= grain) {
+                if(orange::slice(r, b, e) |any_of| p)
+                    found.store(true, std::memory_order_relaxed);
+                return;
+            }
+
+            size_t mid = b + (e - b) / 2;
+            pool.fork_join  ( [&](){ any_in_slices(pool, r, b  , mid, grain, p, found); }
+                            , [&](){ any_in_slices(pool, r, mid, e  , grain, p, found); }
+                            );
+        }
+
+        template<typename R, typename P>
+        bool
+        par_any_of(R & r, par_tag_t<par_any_of_tag_t> tag, P & p)
+        {
+            thread_pool & pool = tag.pool();
+            size_t n = orange:: slice_length(r);
+            std:: atomic<bool> found {false};
+            any_in_slices(pool, r, 0, n, tag.grain_for(n, pool), p, found);
+            return found.load();
+        }
+    }
+
+    // forward 'par_accumulate' and 'par_foreach' via 'as_range()' if the lhs is not a range
+    template<typename R, typename Tag_type
+        , typename Rnonref = std::remove_reference_t<R>
+        , SFINAE_ENABLE_IF_CHECK( !is_range_v<Rnonref> )
+        >
+    auto
+    operator| (R && r, par_tag_t<Tag_type> tag)
+    ->decltype(as_range(std::forward<R>(r)) | tag)
+    {   return as_range(std::forward<R>(r)) | tag; }
+
+    //  |par_accumulate
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> && is_sliceable_v<R> )
+            >
+    auto
+    operator| (R r, par_tag_t<par_accumulate_tag_t> tag) {
+        using value_type = std::remove_reference_t<decltype( std::move(r) | accumulate )>;
+
+        thread_pool & pool = tag.pool();
+        size_t n = orange:: slice_length(r);
+        if(pool.concurrency() == 1)
+            return std::move(r) | accumulate;
+
+        return impl:: accumulate_slices<value_type>(pool, r, 0, n, tag.grain_for(n, pool));
+    }
+
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> && !is_sliceable_v<R> )
+            >
+    auto
+    operator| (R r, par_tag_t<par_accumulate_tag_t>) {
+        return std::move(r) | accumulate;
+    }
+
+    // |par_foreach| and the others that take a function
+    template<typename R, typename Tag_type
+            , SFINAE_ENABLE_IF_CHECK( is_range_v<R> && !std::is_same<Tag_type, par_accumulate_tag_t>{} )
+            >
+    auto
+    operator| (R r, par_tag_t<Tag_type> tag)
+    -> forward_this_with_a_par_tag<R, Tag_type>
+    {   return { std::move(r), tag }; }
+
+    template<typename R, typename Func
+            , SFINAE_ENABLE_IF_CHECK( is_sliceable_v<R> )
+            >
+    auto
+    operator| (forward_this_with_a_par_tag<R,par_foreach_tag_t> r, Func && func)
+    -> void
+    {
+        thread_pool & pool = r.m_tag.pool();
+        size_t n = orange:: slice_length(r.m_r);
+        impl:: foreach_slices(pool, r.m_r, 0, n, r.m_tag.grain_for(n, pool), func);
+    }
+
+    template<typename R, typename Func
+            , SFINAE_ENABLE_IF_CHECK( !is_sliceable_v<R> )
+            >
+    auto
+    operator| (forward_this_with_a_par_tag<R,par_foreach_tag_t> r, Func && func)
+    -> void
+    {
+        std::move(r.m_r) |foreach| func;
+    }
+
+    // |par_find_if|
+    template<typename R, typename P
+            , SFINAE_ENABLE_IF_CHECK( is_sliceable_v<R> )
+            >
+    auto
+    operator| (forward_this_with_a_par_tag<R,par_find_if_tag_t> r, P && p)
+    -> decltype(std::move(r.m_r) |find_if| p)
+    {
+        thread_pool & pool = r.m_tag.pool();
+        if(pool.concurrency() == 1)
+            return std::move(r.m_r) |find_if| p;
+
+        size_t n = orange:: slice_length(r.m_r);
+        impl:: first_found<decltype(std::move(r.m_r) |find_if| p)> found;
+        impl:: find_in_slices(pool, r.m_r, 0, n, r.m_tag.grain_for(n, pool), p, found);
+        return std::move(found.m_value);
+    }
+
+    template<typename R, typename P
+            , SFINAE_ENABLE_IF_CHECK( !is_sliceable_v<R> )
+            >
+    auto
+    operator| (forward_this_with_a_par_tag<R,par_find_if_tag_t> r, P && p)
+    -> decltype(std::move(r.m_r) |find_if| p)
+    {   return std::move(r.m_r) |find_if| p; }
+
+    // |par_any_of| and |par_all_of|
+    template<typename R, typename P
+            , SFINAE_ENABLE_IF_CHECK( is_sliceable_v<R> )
+            >
+    bool
+    operator| (forward_this_with_a_par_tag<R,par_any_of_tag_t> r, P && p)
+    {   return impl:: par_any_of(r.m_r, r.m_tag, p); }
+
+    template<typename R, typename P
+            , SFINAE_ENABLE_IF_CHECK( is_sliceable_v<R> )
+            >
+    bool
+    operator| (forward_this_with_a_par_tag<R,par_all_of_tag_t> r, P && p)
+    {
+        impl:: negated_t<std::remove_reference_t<P>> not_p {p};
+        return !impl:: par_any_of(r.m_r, par_tag_t<par_any_of_tag_t>{ r.m_tag.m_pool, r.m_tag.m_grain }, not_p);
+    }
+
+    template<typename R, typename P
+            , SFINAE_ENABLE_IF_CHECK( !is_sliceable_v<R> )
+            >
+    bool
+    operator| (forward_this_with_a_par_tag<R,par_any_of_tag_t> r, P && p)
+    {   return std::move(r.m_r) |any_of| p; }
+
+    template<typename R, typename P
+            , SFINAE_ENABLE_IF_CHECK( !is_sliceable_v<R> )
+            >
+    bool
+    operator| (forward_this_with_a_par_tag<R,par_all_of_tag_t> r, P && p)
+    {   return std::move(r.m_r) |all_of| p; }
+} // namespace orange
+
+#endif
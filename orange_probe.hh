@@ -0,0 +1,275 @@
+/*
+ * orange_probe  - counting what each stage of a pipeline does
+ *
+ * This is kept separate from orange.hh, as it needs <mutex>, <map> and <chrono>.
+ *
+ *      v   |probe| "input"
+ *          |filter| [](double x) { return x > 0; }
+ *          |probe| "positive"
+ *          |mapr|  [](double x) { return x*x; }
+ *          |accumulate;
+ *
+ *      orange:: probe_registry:: global() .dump(std::cerr);
+ *
+ *      // input:    empty=...  front=...  advance=...  items=...
+ *      // positive: empty=...  front=...  advance=...  items=...
+ *
+ * A '|probe| name' passes its range through unchanged, and counts the calls
+ * made on it by the stage after it: 'empty', 'front', 'advance', and the items
+ * that pass through (by 'advance' or in blocks by 'pull_n'). More calls to
+ * 'front' than items means that something downstream reads each item more
+ * than once, as '|filter|' does for those that pass the predicate.
+ *
+ * The counts are kept in the range itself, and added to the registry under
+ * the name when the range is destroyed. Probes with the same name add up,
+ * including the slices of a probe that '|par_accumulate' runs in other
+ * threads.
+ *
+ * Two macros control it. Define them before including this header:
+ *
+ *      ORANGE_PROBES=0         '|probe| name' just returns its range, so the
+ *                              pipeline compiles exactly as if it weren't there
+ *      ORANGE_PROBE_TIMING=1   also time the calls into the upstream range,
+ *                              with 'std::chrono::steady_clock'. This costs
+ *                              two clock reads per call, so it's off by default
+ */
+
+#ifndef AMD_ORANGE_PROBE_HH
+#define AMD_ORANGE_PROBE_HH
+
+#include "orange.hh"
+
+#include<chrono>
+#include<cstdint>
+#include<map>
+#include<mutex>
+#include<ostream>
+#include<string>
+
+#ifndef ORANGE_PROBES
+#define ORANGE_PROBES 1
+#endif
+#ifndef ORANGE_PROBE_TIMING
+#define ORANGE_PROBE_TIMING 0
+#endif
+
+namespace orange {
+
+    struct probe_counts {
+        uint64_t    m_empty         = 0;
+        uint64_t    m_front         = 0;
+        uint64_t    m_advance       = 0;
+        uint64_t    m_items         = 0;    // advanced over, or pulled by 'pull_n'
+        uint64_t    m_nanoseconds   = 0;    // in the upstream range. Only with ORANGE_PROBE_TIMING
+
+        probe_counts &
+        operator+= (probe_counts const & other) {
+            m_empty         += other.m_empty;
+            m_front         += other.m_front;
+            m_advance       += other.m_advance;
+            m_items         += other.m_items;
+            m_nanoseconds   += other.m_nanoseconds;
+            return *this;
+        }
+
+        bool
+        any()   const { return m_empty || m_front || m_advance || m_items || m_nanoseconds; }
+    };
+
+    /*  probe_registry
+     *  ==============
+     *      The totals for each probe name. 'global()' is the one that '|probe|'
+     *  reports into.
+     */
+    class probe_registry {
+        std:: mutex                             m_mutex;
+        std:: map<std::string, probe_counts>    m_counts;
+
+    public:
+        static
+        probe_registry &
+        global() {
+            static probe_registry registry;
+            return registry;
+        }
+
+        void
+        add(char const * name, probe_counts const & counts) {
+            std:: lock_guard<std::mutex> lock(m_mutex);
+            m_counts[name] += counts;
+        }
+
+        probe_counts
+        counts(std::string const & name) {
+            std:: lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_counts.find(name);
+            return it == m_counts.end() ? probe_counts{} : it->second;
+        }
+
+        std:: map<std::string, probe_counts>
+        snapshot() {
+            std:: lock_guard<std::mutex> lock(m_mutex);
+            return m_counts;
+        }
+
+        void
+        reset() {
+            std:: lock_guard<std::mutex> lock(m_mutex);
+            m_counts.clear();
+        }
+
+        void
+        dump(std::ostream & o) {
+            for(auto const & name_and_counts : snapshot()) {
+                probe_counts const & c = name_and_counts.second;
+                o   << name_and_counts.first << ":"
+                    << "\tempty="   << c.m_empty
+                    << "\tfront="   << c.m_front
+                    << "\tadvance=" << c.m_advance
+                    << "\titems="   << c.m_items;
+                if(ORANGE_PROBE_TIMING)
+                    o << "\tns="    << c.m_nanoseconds;
+                o << '\n';
+            }
+        }
+    };
+
+    namespace impl {
+        // adds the time of its own lifetime to 'm_ns'
+        template<bool timing = ORANGE_PROBE_TIMING != 0>
+        struct probe_timer {
+            uint64_t &                                  m_ns;
+            std:: chrono:: steady_clock:: time_point    m_start;
+
+            explicit probe_timer(uint64_t & ns) : m_ns(ns), m_start(std:: chrono:: steady_clock:: now()) {}
+            ~probe_timer() {
+                m_ns += static_cast<uint64_t>(std:: chrono:: duration_cast<std::chrono::nanoseconds>(
+                                std:: chrono:: steady_clock:: now() - m_start).count());
+            }
+        };
+        template<>
+        struct probe_timer<false> {
+            explicit probe_timer(uint64_t &) {}
+        };
+    }
+
+    /*  probe_range<R>
+     *  ==============
+     *      Moving a probe moves its counts. A copy starts from zero, as it's a
+     *  separate range whose calls are counted separately.
+     */
+    template<typename R>
+    struct probe_range
+    {
+        using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+        static_assert(!std::is_reference<R>{},"");
+        static_assert( is_range_v<R>, "");
+
+        R                       m_r;
+        char const *            m_name;
+        mutable probe_counts    m_counts;
+
+        probe_range(R r, char const * name) : m_r(std::move(r)), m_name(name), m_counts() {}
+
+        probe_range(probe_range const & other) : m_r(other.m_r), m_name(other.m_name), m_counts() {}
+        probe_range(probe_range && other) : m_r(std::move(other.m_r)), m_name(other.m_name), m_counts(other.m_counts)
+        { other.m_counts = probe_counts{}; }
+
+        probe_range &
+        operator= (probe_range const & other) {
+            flush();
+            m_r         = other.m_r;
+            m_name      = other.m_name;
+            return *this;
+        }
+        probe_range &
+        operator= (probe_range && other) {
+            flush();
+            m_r         = std::move(other.m_r);
+            m_name      = other.m_name;
+            m_counts    = other.m_counts;
+            other.m_counts = probe_counts{};
+            return *this;
+        }
+
+        ~probe_range() { flush(); }
+
+        void
+        flush() const {
+            if(m_counts.any())
+                probe_registry:: global().add(m_name, m_counts);
+            m_counts = probe_counts{};
+        }
+
+        template<typename M> static auto
+        orange_empty      (M &m) ->bool
+        {
+            ++m.m_counts.m_empty;
+            impl:: probe_timer<> timer(m.m_counts.m_nanoseconds);
+            return orange::empty(m.m_r);
+        }
+        template<typename M> static auto
+        orange_front      (M &m) ->decltype(orange::front( m.m_r ))
+        {
+            ++m.m_counts.m_front;
+            impl:: probe_timer<> timer(m.m_counts.m_nanoseconds);
+            return orange::front(m.m_r);
+        }
+        template<typename M> static auto
+        orange_advance    (M &m) ->void
+        {
+            ++m.m_counts.m_advance;
+            ++m.m_counts.m_items;
+            impl:: probe_timer<> timer(m.m_counts.m_nanoseconds);
+            orange::advance(m.m_r);
+        }
+        template<typename M, typename U
+                , SFINAE_ENABLE_IF_CHECK( has_trait_pull_n<R&, U> )
+                > static size_t
+        orange_pull_n     (M &m, U *out, size_t n)
+        {
+            impl:: probe_timer<> timer(m.m_counts.m_nanoseconds);
+            size_t got = orange::pull_n(m.m_r, out, n);
+            m.m_counts.m_items += got;
+            return got;
+        }
+
+        // not counted, as they don't touch the items
+        template<typename M> static auto
+        orange_size       (M &m) ->decltype(orange::size( m.m_r ))
+        {   return orange::size( m.m_r ); }
+        template<typename M> static size_hint_t
+        orange_size_hint  (M &m) { return orange::size_hint( m.m_r ); }
+
+        // each slice is a probe of the same name, so the parallel modes are counted too
+        template<typename M> static auto
+        orange_slice      (M &m, size_t b, size_t e)
+        ->probe_range< std::decay_t<decltype(orange::slice( m.m_r, b, e ))> >
+        {   return { orange::slice( m.m_r, b, e ), m.m_name }; }
+        template<typename M> static auto
+        orange_slice_length (M &m)
+        ->decltype(orange::slice_length( m.m_r ))
+        {   return orange::slice_length( m.m_r ); }
+    };
+
+    /*  |probe| name
+     *  ============
+     *      'name' should be a string literal, or otherwise outlive the range.
+     */
+    struct probe_tag_t          {};     constexpr   tagger_t<probe_tag_t        >   probe;
+
+#if ORANGE_PROBES
+    template<typename R>
+    auto
+    operator| (forward_this_with_a_tag<R,probe_tag_t> f, char const * name)
+    { return probe_range<R>{ std::move(f.m_r), name }; }
+#else
+    template<typename R>
+    auto constexpr
+    operator| (forward_this_with_a_tag<R,probe_tag_t> f, char const *)
+    -> R
+    { return std::move(f.m_r); }
+#endif
+}
+
+#endif
@@ -0,0 +1,283 @@
+/*
+ * orange_shard  - splitting a range into shards, to run on other machines
+ *
+ * This is kept separate from orange.hh, as it needs <string> and <sstream>.
+ *
+ *      // the same on every node: the source, and what to do with a piece of it
+ *      auto source     = ints(0, 2000000000);
+ *      auto pipeline   = [](auto r) { return std::move(r) |mapr| compute |filter| keep |accumulate; };
+ *
+ *      // on the driver: one line of text per shard, to send to the workers
+ *      for(shard const & s : make_shards("ints-2e9", source, 64))
+ *          send_to_a_worker( to_string(s) );
+ *
+ *      // on a worker
+ *      shard s     = shard_from_string( received_line );
+ *      auto result = run_shard("ints-2e9", source, s, pipeline);
+ *
+ *      // back on the driver, with the results in the order of 'm_index'
+ *      auto answer = merge_shard_results(results);
+ *
+ * A 'shard' is positions [m_begin, m_end) of a source that can be sliced
+ * (see 'is_sliceable_v' in orange.hh), such as 'ints(l,u)', 'replicate(n,x)',
+ * or 'range::from::mmap_records<T>(path)' over a copy of the file on each
+ * node. It doesn't contain the items, only the name of the source and its
+ * length, so that each worker can check that it has built the same source,
+ * and then slices and runs its own copy of it. 'run_shard' throws
+ * 'std::invalid_argument' if the name or the length don't match.
+ *
+ * Each worker's result goes back to the driver however the job sends
+ * things. 'merge_shard_results' combines them in order, with
+ * 'merge_accumulated(a, b)':
+ *
+ *      numbers                 a + b               (from '|accumulate')
+ *      'std::vector'           b after a           (from '|collect')
+ *      'min_max_t'             both extremes       (from '|min_max')
+ *      'optional_value<T>'     'a' if it has one, else 'b'. As the shards are
+ *                              in order, that's the first from '|find_if|'.
+ *                              Where 'T' is a 'min_max_t', both are merged
+ *      'accumulator<T,Op>'     'a.merge(b)'        (from 'feed'; each 'init'
+ *                                                  must be the identity of 'Op')
+ *
+ * It's not defined for 'bool', as '|any_of|' and '|all_of|' would need
+ * different ones; pass 'std::logical_or<>{}' or 'std::logical_and<>{}' as
+ * the second argument of 'merge_shard_results' instead.
+ *
+ * 'run_all_shards(name, source, count, pipeline)' does all of that in one
+ * process, sending each shard through 'to_string' and 'shard_from_string'.
+ * It's how a job can be tested before it's run on a cluster.
+ */
+
+#ifndef AMD_ORANGE_SHARD_HH
+#define AMD_ORANGE_SHARD_HH
+
+#include "orange.hh"
+
+#include<cstdint>
+#include<iterator>
+#include<sstream>
+#include<stdexcept>
+#include<string>
+#include<vector>
+
+namespace orange {
+
+    /*  shard
+     *  =====
+     *      '.m_index' of '.m_count' shards of the source named '.m_source',
+     *  which has '.m_length' positions in all.
+     */
+    struct shard {
+        std:: string    m_source;
+        uint64_t        m_length    = 0;
+        uint64_t        m_begin     = 0;
+        uint64_t        m_end       = 0;
+        uint64_t        m_index     = 0;
+        uint64_t        m_count     = 0;
+    };
+
+    inline
+    bool
+    operator== (shard const & l, shard const & r) {
+        return  l.m_source == r.m_source
+            &&  l.m_length == r.m_length
+            &&  l.m_begin  == r.m_begin
+            &&  l.m_end    == r.m_end
+            &&  l.m_index  == r.m_index
+            &&  l.m_count  == r.m_count;
+    }
+    inline
+    bool
+    operator!= (shard const & l, shard const & r) { return !(l == r); }
+
+    namespace impl {
+        // the name is written as one word, so it mustn't be empty or contain spaces
+        inline
+        void
+        check_shard_source_name(std::string const & name) {
+            if(name.empty() || name.find_first_of(" \t\r\n") != std::string::npos)
+                throw std:: invalid_argument("orange::shard: the name of the source must be one word, without spaces: '" + name + "'");
+        }
+    }
+
+    /*  to_string, shard_from_string
+     *  ============================
+     *      One line of text, with a version number first:
+     *
+     *          orange-shard 1 <source> <length> <begin> <end> <index> <count>
+     */
+    inline
+    std:: string
+    to_string(shard const & s) {
+        impl:: check_shard_source_name(s.m_source);
+        std:: ostringstream o;
+        o   << "orange-shard 1 " << s.m_source
+            << ' ' << s.m_length
+            << ' ' << s.m_begin << ' ' << s.m_end
+            << ' ' << s.m_index << ' ' << s.m_count;
+        return o.str();
+    }
+
+    inline
+    shard
+    shard_from_string(std::string const & text) {
+        std:: istringstream in(text);
+        std:: string magic;
+        int version = 0;
+        shard s;
+        in >> magic >> version >> s.m_source >> s.m_length >> s.m_begin >> s.m_end >> s.m_index >> s.m_count;
+        std:: string rest;
+        if(!in || magic != "orange-shard" || version != 1 || (in >> rest))
+            throw std:: invalid_argument("orange::shard_from_string: not a shard: '" + text + "'");
+        if(s.m_begin > s.m_end || s.m_end > s.m_length || s.m_index >= s.m_count)
+            throw std:: invalid_argument("orange::shard_from_string: positions out of range: '" + text + "'");
+        return s;
+    }
+
+    /*  make_shards(name, source, count)
+     *  ================================
+     *      'count' shards of nearly equal length, in order. The positions
+     *  are those of 'slice_length(source)', so after a '|filter|' it's the
+     *  positions of the underlying range, not the items that pass.
+     */
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_sliceable_v<R> )
+            >
+    std:: vector<shard>
+    make_shards(std::string const & name, R & source, uint64_t count) {
+        impl:: check_shard_source_name(name);
+        if(count == 0)
+            throw std:: invalid_argument("orange::make_shards: 'count' must be at least 1");
+
+        uint64_t length = static_cast<uint64_t>(orange::slice_length(source));
+        uint64_t each   = length / count;
+        uint64_t extra  = length % count;  // the first 'extra' shards have one more
+
+        std:: vector<shard> shards;
+        shards.reserve(count);
+        uint64_t b = 0;
+        for(uint64_t i = 0; i<count; ++i) {
+            uint64_t e = b + each + (i < extra ? 1 : 0);
+            shards.push_back(shard{ name, length, b, e, i, count });
+            b = e;
+        }
+        return shards;
+    }
+
+    /*  slice_for_shard(name, source, shard), run_shard(name, source, shard, pipeline)
+     *  ==============================================================================
+     *      The slice of this node's copy of the source, after checking that
+     *  it's the same source. 'run_shard' passes it to 'pipeline'.
+     */
+    template<typename R
+            , SFINAE_ENABLE_IF_CHECK( is_sliceable_v<R> )
+            >
+    auto
+    slice_for_shard(std::string const & name, R & source, shard const & s)
+    ->decltype(orange::slice(source, size_t(0), size_t(0)))
+    {
+        if(s.m_source != name)
+            throw std:: invalid_argument("orange::slice_for_shard: the shard is of '" + s.m_source + "', not '" + name + "'");
+        if(static_cast<uint64_t>(orange::slice_length(source)) != s.m_length)
+            throw std:: invalid_argument("orange::slice_for_shard: '" + name + "' here doesn't have the length in the shard");
+        return orange::slice(source, static_cast<size_t>(s.m_begin), static_cast<size_t>(s.m_end));
+    }
+
+    template<typename R, typename Pipeline>
+    auto
+    run_shard(std::string const & name, R & source, shard const & s, Pipeline && pipeline)
+    ->decltype(pipeline(slice_for_shard(name, source, s)))
+    {   return pipeline(slice_for_shard(name, source, s)); }
+
+    /*  merge_accumulated(a, b)
+     *  =======================
+     *      'b' is from the shard after 'a'. See the top of this file.
+     */
+    template<typename T
+            , SFINAE_ENABLE_IF_CHECK( std::is_arithmetic<T>{} && !std::is_same<T, bool>{} )
+            >
+    T
+    merge_accumulated(T a, T b) { return a + b; }
+
+    template<typename T, typename Alloc>
+    std:: vector<T, Alloc>
+    merge_accumulated(std::vector<T, Alloc> a, std::vector<T, Alloc> b) {
+        a.insert(a.end(), std::make_move_iterator(b.begin()), std::make_move_iterator(b.end()));
+        return a;
+    }
+
+    template<typename T>
+    min_max_t<T>
+    merge_accumulated(min_max_t<T> a, min_max_t<T> b) {
+        return { b.m_min < a.m_min ? b.m_min : a.m_min
+               , a.m_max < b.m_max ? b.m_max : a.m_max };
+    }
+
+    // the first one found
+    template<typename T>
+    orange_utils:: optional_value<T>
+    merge_accumulated(orange_utils:: optional_value<T> a, orange_utils:: optional_value<T> b) {
+        return a.has_value() ? a : b;
+    }
+
+    // ... but both extremes
+    template<typename T>
+    orange_utils:: optional_value<min_max_t<T>>
+    merge_accumulated(orange_utils:: optional_value<min_max_t<T>> a, orange_utils:: optional_value<min_max_t<T>> b) {
+        if(a.has_value() && b.has_value())
+            a.emplace(merge_accumulated(*a, *b));
+        return a.has_value() ? a : b;
+    }
+
+    // an accumulator fed by each shard. The 'init' of each must be the
+    // identity of 'Op', as its total includes it
+    template<typename T, typename Op>
+    accumulator<T, Op>
+    merge_accumulated(accumulator<T, Op> a, accumulator<T, Op> const & b) {
+        a.merge(b);
+        return a;
+    }
+
+    namespace impl {
+        struct merge_accumulated_t {
+            template<typename T>
+            auto
+            operator() (T a, T b) const
+            ->decltype(merge_accumulated(std::move(a), std::move(b)))
+            {   return merge_accumulated(std::move(a), std::move(b)); }
+        };
+    }
+
+    /*  merge_shard_results(results, op)
+     *  ================================
+     *      The results must be in the order of the shards, and there must be
+     *  at least one.
+     */
+    template<typename T, typename Op = impl:: merge_accumulated_t>
+    T
+    merge_shard_results(std::vector<T> results, Op op = Op{}) {
+        if(results.empty())
+            throw std:: invalid_argument("orange::merge_shard_results: there are no results");
+        T total = std::move(results[0]);
+        for(size_t i = 1; i<results.size(); ++i)
+            total = op(std::move(total), std::move(results[i]));
+        return total;
+    }
+
+    /*  run_all_shards(name, source, count, pipeline, op)
+     *  =================================================
+     *      The whole job, in this process.
+     */
+    template<typename R, typename Pipeline, typename Op = impl:: merge_accumulated_t>
+    auto
+    run_all_shards(std::string const & name, R & source, uint64_t count, Pipeline && pipeline, Op op = Op{})
+    {
+        using result_type = std::decay_t<decltype(run_shard(name, source, std::declval<shard const &>(), pipeline))>;
+        std:: vector<result_type> results;
+        for(shard const & s : make_shards(name, source, count))
+            results.push_back(run_shard(name, source, shard_from_string(to_string(s)), pipeline));
+        return merge_shard_results(std::move(results), op);
+    }
+}
+
+#endif
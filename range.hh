@@ -3,6 +3,7 @@
 #include<utility>
 #include<stdexcept>
 #include<numeric> // for std::accumulate
+#include<cstdint>
 
 #include<vector>
 #include<tuple>
@@ -10,6 +11,7 @@
 
 #include<memory>
 #include<iostream> // just so I can implement operator <<
+#include<cassert>
 
 #include"../module-bits.and.pieces/utils.hh"
 
@@ -76,6 +78,30 @@ namespace range {
     template<typename R >
     auto advance(R&& r) -> AMD_RANGE_DECLTYPE_AND_RETURN( std::forward<R>(r).advance() )
 
+    // Synthesize 'size' - only for ranges that know exactly how many items remain
+    template<typename R >
+    auto size(R&& r) -> AMD_RANGE_DECLTYPE_AND_RETURN( std::forward<R>(r).size() )
+
+    // Synthesize 'advance_n' - skip up to 'n' values, returning how many were skipped.
+    // Random-access ranges do this in one step, others 'advance' one at a time
+    namespace impl {
+        template<typename R >
+        auto advance_n_impl(R&& r, size_t n, utils:: priority_tag<3>) -> AMD_RANGE_DECLTYPE_AND_RETURN(
+                static_cast<size_t>( std::forward<R>(r).advance_n(n) ) )
+        template<typename R >
+        size_t advance_n_impl(R&& r, size_t n, utils:: priority_tag<1>)
+        {
+            size_t i = 0;
+            for(; i<n && !range:: empty(r); ++i)
+                range:: advance(r);
+            return i;
+        }
+    }
+    template<typename R >
+    size_t advance_n(R&& r, size_t n) {
+        return impl:: advance_n_impl(std::forward<R>(r), n, utils:: priority_tag<9>());
+    }
+
     // Synthesize 'push_back'
     template<typename R, typename T>
     auto push_back(R&& r, T &&t)
@@ -122,6 +148,18 @@ namespace range {
         bool empty() const { return m_b == m_e; }
         void advance()     { ++m_b; }
         auto current_it() const { return m_b; }
+        // only for random-access iterators
+        template<typename b_t2 = b_t>
+        auto size() const -> decltype( static_cast<size_t>( std::declval<e_t const &>() - std::declval<b_t2 const &>() ) )
+        { return static_cast<size_t>(m_e - m_b); }
+        template<typename b_t2 = b_t>
+        auto advance_n(size_t n) -> decltype( static_cast<size_t>( std::declval<e_t const &>() - std::declval<b_t2 const &>() ) )
+        {
+            size_t count = size();
+            if(count > n) count = n;
+            m_b += static_cast<std::ptrdiff_t>(count);
+            return count;
+        }
         // should consider a more flexible front_ref that tries to
         // return the least cv-qualified version that it can
         decltype(auto)           front_ref() const   { return *m_b; }
@@ -176,6 +214,13 @@ namespace range {
         bool        empty()     const   { return  m_b == m_e; }
         void        advance()           {       ++m_b; }
         I           front_val  () const { return  m_b; }
+        size_t      size()      const   { return  m_e < m_b ? 0 : static_cast<size_t>(m_e - m_b); }
+        size_t      advance_n(size_t n) {
+            size_t count = size();
+            if(count > n) count = n;
+            m_b += static_cast<I>(count);
+            return count;
+        }
         constexpr
         bool        is_definitely_infinite() const {
             if(is_infinite)
@@ -215,6 +260,8 @@ namespace range {
 
         bool    empty()         const   { return m_i >= m_v.size(); }
         void    advance  ()             { ++m_i; }
+        size_t  size()          const   { return empty() ? 0 : m_v.size() - m_i; }
+        size_t  advance_n(size_t n)     { size_t count = size(); if(count > n) count = n; m_i += count; return count; }
         decltype(auto)    front_ref()     const   { return get_fwd().at(m_i); }
         decltype(auto)    front_ref()             { return get_fwd().at(m_i); }
 
@@ -258,6 +305,30 @@ namespace range {
                 ( std::forward<V>(v), 0 );
     }
 
+    /* bit_words_t
+     *      A range of bools packed into 64-bit words, lowest bit first, as
+     *  a bitset stores them. Non-owning. 'view::which' reads it a word at
+     *  a time rather than a bit at a time.
+     */
+    struct bit_words_t {
+        uint64_t const *    m_words;
+        size_t              m_n_bits;
+        size_t              m_i;
+
+        using value_type = bool;
+
+        bool    empty()         const   { return m_i >= m_n_bits; }
+        void    advance()               { ++m_i; }
+        bool    front_val()     const   { return (m_words[m_i / 64] >> (m_i % 64)) & 1u; }
+        size_t  size()          const   { return empty() ? 0 : m_n_bits - m_i; }
+        size_t  advance_n(size_t n)     { size_t count = size(); if(count > n) count = n; m_i += count; return count; }
+    };
+
+    inline
+    bit_words_t from_bit_words(uint64_t const * words, size_t n_bits) {
+        return { words, n_bits, 0 };
+    }
+
     template<bool enforce_same_length, typename idx, typename ... range_types>
     struct zip_val_t;
     template<bool enforce_same_length, size_t ...Is, typename ...Rs>
@@ -340,31 +411,27 @@ namespace range {
     }
 
 
+    // For range-based for. 'end' is an empty sentinel type, so '!=' is just '!empty()'.
+    // Before C++17, 'begin' and 'end' must have the same type, so 'end' is then a
+    // 'begin_end_for_range_for' with a null pointer. The only checks are asserts.
+    struct range_for_sentinel {};
+
     template<typename R>
     struct begin_end_for_range_for {
 
         R * m_range_pointer;
 
-        bool operator != ( const begin_end_for_range_for & other ) const {
-            if(other.m_range_pointer == nullptr && this->m_range_pointer == nullptr) {
-                // both are end-iterators.
-                return false;
-            }
-            if(other.m_range_pointer == nullptr && this->m_range_pointer != nullptr) {
-                return !this->m_range_pointer->empty();
-            }
-            if(other.m_range_pointer != nullptr && this->m_range_pointer == nullptr) {
-                return !other.m_range_pointer->empty();
-            }
-            // BUG INCOMPLETE
-            throw std:: runtime_error("range:: range-based-for (incomplete checks here)");
+        bool operator != ( range_for_sentinel ) const {
+            return !this->m_range_pointer->empty();
         }
-        void error_now_if_I_am_empty() const {
-              this->m_range_pointer           || [](){throw std:: runtime_error("range:: range-based-for (++end)"    );return false;}();
-            (!this->m_range_pointer->empty()) || [](){throw std:: runtime_error("range:: range-based-for (++empty())");return false;}();
+        // only to compare against 'end' before C++17
+        bool operator != ( const begin_end_for_range_for & end ) const {
+            assert(end.m_range_pointer == nullptr);
+            (void)end;
+            return !this->m_range_pointer->empty();
         }
         begin_end_for_range_for& operator++() {
-            error_now_if_I_am_empty();
+            assert(!this->m_range_pointer->empty());
             this->m_range_pointer->advance();
             return *this;
         }
@@ -373,7 +440,7 @@ namespace range {
         auto operator_star_impl(utils:: priority_tag<2>)    const
         -> decltype( std::declval<Myself>().front_ref() )
         {
-            error_now_if_I_am_empty();
+            assert(!this->m_range_pointer->empty());
             return   this->m_range_pointer->front_ref();
         }
 
@@ -381,7 +448,7 @@ namespace range {
         auto operator_star_impl(utils:: priority_tag<1>)    const
         -> decltype( std::declval<Myself>().front_val() )
         {
-            error_now_if_I_am_empty();
+            assert(!this->m_range_pointer->empty());
             return   this->m_range_pointer->front_val();
         }
         auto operator*() const
@@ -390,9 +457,15 @@ namespace range {
             )
     };
 
+#if defined(__cpp_range_based_for) && __cpp_range_based_for >= 201603L
+    template<typename R>
+    auto end  (R &)
+    -> decltype(void(begin_end_for_range_for<R> { nullptr }), range_for_sentinel{}) { return {}; }
+#else
     template<typename R>
     auto end  (R &)
     -> AMD_RANGE_DECLTYPE_AND_RETURN(begin_end_for_range_for<R> { nullptr })
+#endif
     template<typename R >
     auto begin(R &r)
     -> AMD_RANGE_DECLTYPE_AND_RETURN(begin_end_for_range_for<R> { &r })
@@ -5,6 +5,7 @@
 
 #include <type_traits>
 #include <vector>
+#include <memory> // for 'std::allocator_traits'
 
 namespace range {
 namespace action {
@@ -14,17 +15,69 @@ namespace action {
     struct {} foreach;
     struct {} unzip_foreach;
 
+    namespace impl {
+        // reserve once up front, if the range knows its size
+        template<typename V, typename R>
+        auto reserve_if_size_known(V &v, R && r, utils:: priority_tag<2>)
+        -> decltype( (void)range:: size(AMD_FORWARD(r)) )
+        {   v.reserve( range:: size(AMD_FORWARD(r)) ); }
+        template<typename V, typename R>
+        void reserve_if_size_known(V &, R &&, utils:: priority_tag<1>) {}
+    }
+
     template<typename R>
     auto operator| (R && r, decltype(collect) )
     {
         using value_type = std:: decay_t< decltype( range:: pull(AMD_FORWARD(r)) ) >;
         std:: vector<value_type> v;
+        impl:: reserve_if_size_known(v, r, utils:: priority_tag<9>{});
         while(!AMD_FORWARD(r).empty()) {
             v.push_back( range:: pull(AMD_FORWARD(r)) );
         }
         return v;
     }
 
+    /* collect_with(alloc), unzip_collect_transpose_with(alloc)
+     *      As 'collect' and 'unzip_collect_transpose', but each 'std::vector'
+     *      uses a copy of 'alloc', rebound to its element type. For example,
+     *      an arena allocator, where many small vectors are thrown away together.
+     */
+    template<typename Alloc>
+    struct collect_with_t                   { Alloc m_alloc; };
+    template<typename Alloc>
+    struct unzip_collect_transpose_with_t   { Alloc m_alloc; };
+
+    template<typename Alloc>
+    collect_with_t<Alloc>                   collect_with                    (Alloc alloc) { return { std::move(alloc) }; }
+    template<typename Alloc>
+    unzip_collect_transpose_with_t<Alloc>   unzip_collect_transpose_with    (Alloc alloc) { return { std::move(alloc) }; }
+
+    template<typename R, typename Alloc>
+    auto operator| (R && r, collect_with_t<Alloc> with )
+    {
+        using value_type = std:: decay_t< decltype( range:: pull(AMD_FORWARD(r)) ) >;
+        using allocator_type = typename std:: allocator_traits<Alloc>:: template rebind_alloc<value_type>;
+        std:: vector<value_type, allocator_type> v{ allocator_type(with.m_alloc) };
+        impl:: reserve_if_size_known(v, r, utils:: priority_tag<9>{});
+        while(!AMD_FORWARD(r).empty()) {
+            v.push_back( range:: pull(AMD_FORWARD(r)) );
+        }
+        return v;
+    }
+
+    template<size_t ...Is, typename R, typename Alloc>
+    auto operator_pipe_impl (R r, unzip_collect_transpose_with_t<Alloc> with, std:: index_sequence<Is...> )
+    {
+        return std::make_tuple( std:: get<Is>( move( r.m_ranges)) | range:: action:: collect_with(with.m_alloc) ... );
+    }
+    template<typename R, typename Alloc>
+    auto operator| (R r, unzip_collect_transpose_with_t<Alloc> with )
+    {
+        return operator_pipe_impl( move(r), with
+                , std:: make_index_sequence< r.width_v >{}
+                );
+    }
+
     template<size_t ...Is, typename R>
     auto operator_pipe_impl (R r, decltype(unzip_collect_transpose), std:: index_sequence<Is...> )
     {
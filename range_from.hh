@@ -2,6 +2,29 @@
 #define AMD_RANGE_FROM_HH
 
 #include"range.hh"
+
+#include<cstring> // for std::memchr
+#include<string>
+#if __cplusplus >= 201703L
+#include<string_view>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define AMD_RANGE_FROM_HAS_MMAP 1
+#include<cerrno>
+#include<memory>
+#include<stdexcept>
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<unistd.h>
+#endif
+
+namespace orange {
+    // declared only, so that 'from_lines_t' can be used with 'orange::' without this header needing "orange.hh"
+    struct orange_traits_are_static_here;
+}
+
 namespace range {
 namespace from {
 
@@ -32,6 +55,269 @@ auto    ifstream(T_vl && f) {
     return from_ifstream_t<T_vl>( AMD_FORWARD(f) );
 }
 
+/*  from_lines_t
+ *  ============
+ *      One line at a time from an istream, like 'ifstream', but without
+ *  'std::getline'. Large blocks are read into one buffer, and each line is
+ *  found there with 'memchr'. The buffer only grows if a single line doesn't
+ *  fit.
+ *
+ *  lines(f)           - each line is a 'line_view' into the buffer, which is
+ *                       only valid until the next 'advance()'.
+ *  owning_lines(f)    - each line is copied into its own 'std::string', for
+ *                       pipelines that keep lines after 'advance()'.
+ *
+ *  As with 'std::getline', a final '\n' doesn't give an extra empty line.
+ *  These can be used with 'range::view' and also with 'orange::'.
+ */
+/*  line_view
+ *      What 'lines' gives: 'std::string_view' in C++17. Before that, it's a
+ *  pointer and a length with the parts of 'string_view' that are needed to
+ *  read a line, and 'to_string()' to keep it.
+ */
+#if __cplusplus >= 201703L
+using line_view = std:: string_view;
+#else
+struct line_view {
+    char const *    m_data;
+    size_t          m_size;
+
+    constexpr line_view()                               : m_data(nullptr), m_size(0) {}
+    constexpr line_view(char const * data, size_t size) : m_data(data), m_size(size) {}
+
+    constexpr char const *  data()              const   { return m_data; }
+    constexpr size_t        size()              const   { return m_size; }
+    constexpr size_t        length()            const   { return m_size; }
+    constexpr bool          empty()             const   { return m_size == 0; }
+    constexpr char const *  begin()             const   { return m_data; }
+    constexpr char const *  end()               const   { return m_data + m_size; }
+    constexpr char          operator[](size_t i) const  { return m_data[i]; }
+    std:: string            to_string()         const   { return std:: string(m_data, m_size); }
+    explicit operator std:: string()            const   { return to_string(); }
+
+    friend bool operator== (line_view l, line_view r) {
+        return l.m_size == r.m_size && (l.m_size == 0 || std:: memcmp(l.m_data, r.m_data, l.m_size) == 0);
+    }
+    friend bool operator!= (line_view l, line_view r) { return !(l == r); }
+    friend std:: ostream & operator<< (std:: ostream & o, line_view l) {
+        return o.write(l.m_data, static_cast<std::streamsize>(l.m_size));
+    }
+};
+#endif
+
+template<typename T_vl, typename T_line>
+struct from_lines_t {
+    T_vl                m_f;
+    std:: vector<char>  m_buffer;
+    size_t              m_begin;        // the current line is [m_begin, m_line_end)
+    size_t              m_line_end;
+    size_t              m_next;         // the start of the following line
+    size_t              m_end;          // [m_end, m_buffer.size()) hasn't been filled yet
+    bool                m_empty;
+
+    static_assert(!std:: is_rvalue_reference<T_vl>{} ,"");
+    using value_type = T_line;
+
+    static constexpr size_t default_buffer_size = 1 << 16;
+
+    template<typename T>
+    from_lines_t(T&& f, size_t buffer_size = default_buffer_size)
+                                :   m_f(AMD_FORWARD(f))
+                                ,   m_buffer(buffer_size > 0 ? buffer_size : 1)
+                                ,   m_begin(0)
+                                ,   m_line_end(0)
+                                ,   m_next(0)
+                                ,   m_end(0)
+                                ,   m_empty(false)
+    {
+        advance();
+    }
+
+    T_line                  front_val()     const   { return T_line(m_buffer.data() + m_begin, m_line_end - m_begin); }
+    bool                    empty()         const   { return m_empty; }
+    void                    advance()               {
+        m_begin = m_next;
+        size_t searched = m_begin;
+        while(true) {
+            void const * nl = std:: memchr(m_buffer.data() + searched, '\n', m_end - searched);
+            if(nl) {
+                m_line_end  = static_cast<char const*>(nl) - m_buffer.data();
+                m_next      = m_line_end + 1;
+                return;
+            }
+            searched = m_end;
+            if(!refill(searched))
+                break;
+        }
+        // no more input. Anything left over is the last line, without its '\n'
+        if(m_begin == m_end) {
+            m_empty = true;
+            return;
+        }
+        m_line_end  = m_end;
+        m_next      = m_end;
+    }
+
+    // orange:: traits
+    using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+    template<typename M> static bool    orange_empty    (M &m) { return m.empty(); }
+    template<typename M> static void    orange_advance  (M &m) { m.advance(); }
+    template<typename M> static T_line  orange_front    (M &m) { return m.front_val(); }
+
+private:
+    // Read some more, keeping the partial line at [m_begin,m_end) but moving it
+    // to the start. 'searched' is adjusted to match. Returns false at the end of input
+    bool                    refill(size_t & searched) {
+        if(!m_f)
+            return false;
+        if(m_begin > 0) {
+            std:: memmove(m_buffer.data(), m_buffer.data() + m_begin, m_end - m_begin);
+            m_end       -= m_begin;
+            searched    -= m_begin;
+            m_begin      = 0;
+        }
+        if(m_end == m_buffer.size())
+            m_buffer.resize(2 * m_buffer.size());
+        m_f.read(m_buffer.data() + m_end, static_cast<std::streamsize>(m_buffer.size() - m_end));
+        size_t got = static_cast<size_t>(m_f.gcount());
+        m_end += got;
+        return got > 0;
+    }
+};
+
+template<typename T_vl>
+auto    lines(T_vl && f, size_t buffer_size = from_lines_t<T_vl, line_view>::default_buffer_size) {
+    return from_lines_t<T_vl, line_view>( AMD_FORWARD(f), buffer_size );
+}
+
+template<typename T_vl>
+auto    owning_lines(T_vl && f, size_t buffer_size = from_lines_t<T_vl, std::string>::default_buffer_size) {
+    return from_lines_t<T_vl, std:: string>( AMD_FORWARD(f), buffer_size );
+}
+
+#ifdef AMD_RANGE_FROM_HAS_MMAP
+/*  mmap_records<T>(path)
+ *  =====================
+ *      The file at 'path', memory-mapped read-only, as a contiguous range of
+ *  'T const &'. Nothing is copied until it's read. The file's size must be a
+ *  multiple of 'sizeof(T)'. Throws 'std::runtime_error' if the file can't be
+ *  opened or mapped.
+ *
+ *      Copies, and slices, share the mapping, which is unmapped when the last
+ *  of them is gone. So it can be copied cheaply, and sliced for the
+ *  '|par_*' operations in orange_par.hh.
+ */
+namespace impl {
+    struct mapped_file {
+        void *      m_address   = nullptr;
+        size_t      m_length    = 0;
+
+        mapped_file() = default;
+        mapped_file             (mapped_file const &) = delete;
+        mapped_file & operator= (mapped_file const &) = delete;
+        ~mapped_file() {
+            if(m_address)
+                ::munmap(m_address, m_length);
+        }
+    };
+
+    inline
+    std:: runtime_error
+    mmap_error(char const * what, std:: string const & path) {
+        int err = errno;
+        return std:: runtime_error(std::string("range::from::mmap_records: ") + what + " '" + path + "': " + std::strerror(err));
+    }
+
+    inline
+    std:: shared_ptr<mapped_file const>
+    map_whole_file(std:: string const & path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+            throw mmap_error("can't open", path);
+
+        struct stat st;
+        if(::fstat(fd, &st) != 0) {
+            auto e = mmap_error("can't stat", path);
+            ::close(fd);
+            throw e;
+        }
+
+        auto m = std:: make_shared<mapped_file>();
+        m->m_length = static_cast<size_t>(st.st_size);
+        if(m->m_length > 0) { // mmap refuses a zero length
+            void * address = ::mmap(nullptr, m->m_length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(address == MAP_FAILED) {
+                auto e = mmap_error("can't map", path);
+                ::close(fd);
+                throw e;
+            }
+            m->m_address = address;
+            ::madvise(address, m->m_length, MADV_SEQUENTIAL);
+        }
+        ::close(fd); // the mapping stays valid
+        return m;
+    }
+}
+
+template<typename T>
+struct mmap_records_t {
+    static_assert(std:: is_trivially_copyable<T>{} ,"");
+
+    std:: shared_ptr<impl::mapped_file const>   m_file;
+    T const *                                   m_b;
+    T const *                                   m_e;
+
+    using value_type = T;
+
+    explicit
+    mmap_records_t(std:: string const & path)
+    : m_file(impl:: map_whole_file(path))
+    , m_b(static_cast<T const*>(m_file->m_address))
+    , m_e(m_b + m_file->m_length / sizeof(T))
+    {
+        if(m_file->m_length % sizeof(T) != 0)
+            throw std:: runtime_error("range::from::mmap_records: the size of '" + path + "' isn't a multiple of the record size");
+    }
+
+    mmap_records_t(std:: shared_ptr<impl::mapped_file const> file, T const *b, T const *e)
+    : m_file(std::move(file)), m_b(b), m_e(e) {}
+
+    bool        empty()         const   { return m_b == m_e; }
+    void        advance()               { ++m_b; }
+    size_t      size()          const   { return static_cast<size_t>(m_e - m_b); }
+    T const &   front_ref()     const   { return *m_b; }
+    T const *   begin()         const   { return m_b; }
+    T const *   end()           const   { return m_e; }
+    T const *   data()          const   { return m_b; }
+
+    // positions [b,e), sharing the same mapping
+    mmap_records_t slice(size_t b, size_t e) const { return {m_file, m_b + b, m_b + e}; }
+
+    // orange:: traits
+    using orange_traits_are_static_here = orange:: orange_traits_are_static_here;
+    template<typename M> static bool        orange_empty    (M &m)  { return m.empty(); }
+    template<typename M> static void        orange_advance  (M &m)  { m.advance(); }
+    template<typename M> static T const &   orange_front    (M &m)  { return m.front_ref(); }
+    template<typename M> static size_t      orange_size     (M &m)  { return m.size(); }
+    template<typename M> static T const *   orange_begin    (M &m)  { return m.begin(); }
+    template<typename M> static T const *   orange_end      (M &m)  { return m.end(); }
+    template<typename M> static T const *   orange_data     (M &m)  { return m.data(); }
+    template<typename M> static auto        orange_slice    (M &m, size_t b, size_t e) { return m.slice(b, e); }
+    template<typename M, typename U> static size_t
+    orange_pull_n   (M &m, U *out, size_t n) {
+        size_t got = n < m.size() ? n : m.size();
+        std:: copy(m.m_b, m.m_b + got, out);
+        m.m_b += got;
+        return got;
+    }
+};
+
+template<typename T>
+mmap_records_t<T>   mmap_records(std:: string const & path) {
+    return mmap_records_t<T>(path);
+}
+#endif
+
 template<typename T_vl>
 auto    vector(T_vl && f) {
     return range:: from_vector( AMD_FORWARD(f) );
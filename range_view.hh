@@ -21,6 +21,7 @@ namespace view {
 
     struct {} ref_wraps;
     struct {} which;        // given a range of bools, return the indices (int64_t) of those that are true
+    struct {} which_collect;// ... all of them at once, as a vector<uint64_t>
     struct {} map;
     struct {} take;
     struct {} skip;
@@ -31,6 +32,8 @@ namespace view {
     auto operator| (R r, decltype(ref_wraps) );
     template<typename R>
     auto operator| (R r, decltype(which) );
+    template<typename R>
+    auto operator| (R r, decltype(which_collect) );
 
     template<typename R>
     struct ref_wraps_impl {
@@ -100,9 +103,196 @@ namespace view {
             }
         };
     }
+
+    /* The fast path for 'which'
+     *      When the bools are contiguous bytes (pointers or vector iterators
+     *  over 'bool' or 'uint8_t', or a 'from_vector' of them, but not of a
+     *  'std::vector<bool>'), or packed bits ('from_bit_words'), 'which' reads
+     *  them as a 'mask': a sequence of 64-bit blocks with one bit set for
+     *  each true item. Bytes are read eight to a block, keeping the top bit
+     *  of each nonzero byte. Then the next index is a count of trailing
+     *  zeros, and a run of false items costs one test per block instead of
+     *  one per item.
+     */
+    namespace impl {
+        inline int count_trailing_zeros(uint64_t x) { // 'x' must be nonzero
+#if defined(__GNUC__)
+            return __builtin_ctzll(x);
+#else
+            int n = 0;
+            for(; !(x & 1u); x >>= 1) ++n;
+            return n;
+#endif
+        }
+        inline int count_ones(uint64_t x) {
+#if defined(__GNUC__)
+            return __builtin_popcountll(x);
+#else
+            int n = 0;
+            for(; x; x &= x-1) ++n;
+            return n;
+#endif
+        }
+
+        struct byte_mask {
+            unsigned char const *   m_bytes;
+            size_t                  m_n;
+
+            size_t      number_of_blocks()          const { return (m_n + 7) / 8; }
+            uint64_t    block(size_t b)             const {
+                unsigned char const * p = m_bytes + 8*b;
+                uint64_t    w   = 0;
+                // assembled byte by byte, so that byte k is at bits [8k,8k+8) whatever the
+                // endianness. For a full block, the compilers turn this back into one load.
+                if(m_n - 8*b >= 8)
+                    for(size_t k = 0; k < 8; ++k)
+                        w |= uint64_t(p[k]) << (8*k);
+                else
+                    for(size_t k = 0; k < m_n - 8*b; ++k)
+                        w |= uint64_t(p[k]) << (8*k);
+                // the top bit of each nonzero byte
+                constexpr uint64_t low7s = 0x7f7f7f7f7f7f7f7fu;
+                return (((w & low7s) + low7s) | w) & ~low7s;
+            }
+            size_t      index(size_t b, int bit)    const { return 8*b + static_cast<size_t>(bit) / 8; }
+        };
+        struct bit_mask {
+            uint64_t const *        m_words;
+            size_t                  m_first;    // the bit that is index 0
+            size_t                  m_n_bits;
+
+            size_t      number_of_blocks()          const { return (m_n_bits + 63) / 64 - m_first / 64; }
+            uint64_t    block(size_t b)             const {
+                size_t      word    = m_first / 64 + b;
+                uint64_t    w       = m_words[word];
+                if(b == 0)
+                    w &= ~uint64_t(0) << (m_first % 64);
+                if(m_n_bits < 64*(word+1))
+                    w &= ~(~uint64_t(0) << (m_n_bits % 64));
+                return w;
+            }
+            size_t      index(size_t b, int bit)    const { return 64*(m_first / 64 + b) + static_cast<size_t>(bit) - m_first; }
+        };
+
+        template<typename T>
+        using is_mask_byte = std:: integral_constant<bool, std:: is_integral<T>{} && sizeof(T) == 1>;
+
+        template<typename T
+                , std::enable_if_t< is_mask_byte<std::remove_cv_t<T>>{} >* = nullptr>
+        byte_mask   mask_of(range_from_begin_end_t<T*, T*> const & r, utils:: priority_tag<3>) {
+            return { reinterpret_cast<unsigned char const *>(r.m_b), static_cast<size_t>(r.m_e - r.m_b) };
+        }
+        template<typename It
+                , typename T = std::remove_cv_t<std::remove_reference_t<decltype(*std::declval<It const&>())>>
+                , std::enable_if_t<     is_mask_byte<T>{}
+                                    && !std:: is_same<T, bool>{}    // 'vector<bool>' iterators give proxies or copies
+                                    && (    std:: is_same<It, typename std:: vector<T>:: iterator>{}
+                                        ||  std:: is_same<It, typename std:: vector<T>:: const_iterator>{}) >* = nullptr>
+        byte_mask   mask_of(range_from_begin_end_t<It, It> const & r, utils:: priority_tag<2>) {
+            size_t n = static_cast<size_t>(r.m_e - r.m_b);
+            return { n == 0 ? nullptr : reinterpret_cast<unsigned char const *>(std:: addressof(*r.m_b)), n };
+        }
+        template<typename V
+                , typename T = typename std::decay_t<V>:: value_type
+                , std::enable_if_t<     is_mask_byte<T>{}
+                                    && !std:: is_same<T, bool>{}    // 'vector<bool>' is packed, without '.data()'
+                                    &&  std:: is_same<std::decay_t<V>, std:: vector<T>>{} >* = nullptr>
+        byte_mask   mask_of(from_vector_t<V> const & r, utils:: priority_tag<2>) {
+            size_t n = r.size();
+            return { n == 0 ? nullptr : reinterpret_cast<unsigned char const *>(r.m_v.data() + r.m_i), n };
+        }
+        inline
+        bit_mask    mask_of(bit_words_t const & r, utils:: priority_tag<2>) {
+            return { r.m_words, r.m_i, r.m_n_bits };
+        }
+
+        template<typename R>
+        using mask_of_t = decltype( mask_of( std::declval<R const &>(), utils:: priority_tag<9>{}) );
+
+        /* which_in_mask_t
+         *      'm_found' is the bits of the current block that are yet to be
+         *  visited. It's zero only once the mask is finished.
+         */
+        template<typename R>
+        struct which_in_mask_t {
+            R               m_r;    // only held to keep the mask alive
+            mask_of_t<R>    m_mask;
+            size_t          m_block;
+            uint64_t        m_found;
+
+            explicit which_in_mask_t(R r)
+                : m_r(std::move(r))
+                , m_mask( mask_of(m_r, utils:: priority_tag<9>{}) )
+                , m_block(0)
+                , m_found(m_mask.number_of_blocks() == 0 ? 0 : m_mask.block(0))
+            { skip_empty_blocks(); }
+            // Moving 'm_r' doesn't move the bytes it refers to (a moved vector keeps
+            // its buffer), so the defaulted moves leave 'm_mask' valid
+
+            void        skip_empty_blocks()     {
+                size_t const n = m_mask.number_of_blocks();
+                while(m_found == 0 && ++m_block < n)
+                    m_found = m_mask.block(m_block);
+            }
+
+            bool        empty()         const   { return m_found == 0; }
+            uint64_t    front_val()     const   {
+                assert(!empty());
+                return m_mask.index(m_block, count_trailing_zeros(m_found));
+            }
+            void        advance()               {
+                assert(!empty());
+                m_found &= m_found - 1; // clear the lowest bit
+                skip_empty_blocks();
+            }
+        };
+
+        template<typename R
+                , typename = mask_of_t<R> >
+        auto make_which(R r, utils:: priority_tag<2>)
+        -> which_in_mask_t<R>
+        {   return which_in_mask_t<R>{ std:: move(r) }; }
+        template<typename R>
+        auto make_which(R r, utils:: priority_tag<1>)
+        -> which_impl<R>
+        {   return which_impl<R> {std:: move(r), impl::special_index_notevenstarted}; }
+
+        template<typename R>
+        auto which_collect_impl(R & r, utils:: priority_tag<2>)
+        -> decltype( (void)mask_of(r, utils:: priority_tag<9>{}), std:: vector<uint64_t>{} )
+        {
+            auto const      mask    = mask_of(r, utils:: priority_tag<9>{});
+            size_t const    n       = mask.number_of_blocks();
+
+            // count first, so that the indices can be written straight into place
+            size_t total = 0;
+            for(size_t b = 0; b < n; ++b)
+                if(uint64_t found = mask.block(b))
+                    total += static_cast<size_t>(count_ones(found));
+
+            std:: vector<uint64_t> indices(total);
+            uint64_t * out = indices.data();
+            for(size_t b = 0; b < n; ++b)
+                for(uint64_t found = mask.block(b); found; found &= found - 1)
+                    *out++ = mask.index(b, count_trailing_zeros(found));
+            return indices;
+        }
+        template<typename R>
+        std:: vector<uint64_t>  which_collect_impl(R & r, utils:: priority_tag<1>)
+        {
+            std:: vector<uint64_t> indices;
+            for(auto w = which_impl<R> {std:: move(r), impl::special_index_notevenstarted}; !range::empty(w); range::advance(w))
+                indices.push_back( range:: front_val(w) );
+            return indices;
+        }
+    }
     template<typename R>
     auto operator| (R r, decltype(which) ) {
-        return impl:: which_impl<R> {std:: move(r), impl::special_index_notevenstarted};
+        return impl:: make_which(std:: move(r), utils:: priority_tag<9>{});
+    }
+    template<typename R>
+    auto operator| (R r, decltype(which_collect) ) {
+        return impl:: which_collect_impl(r, utils:: priority_tag<9>{});
     }
 
     template<typename R>
@@ -193,6 +383,9 @@ namespace view {
             return f( range:: front_val(m_r) );
         }
         void advance() { m_r.advance(); }
+        template<typename RR = R>
+        auto size() const -> decltype( range:: size(std::declval<RR const &>()) ) { return range:: size(m_r); }
+        size_t advance_n(size_t n) { return range:: advance_n(m_r, n); }
     };
     template<typename R, typename F>
     auto operator| (detail:: temporary_tagged_holder<R, decltype(map)> r_holder, F f)
@@ -211,6 +404,19 @@ namespace view {
             return range:: front_val(m_r);
         }
         void advance() { --m_how_many; m_r.advance(); }
+        // a negative 'm_how_many' never reaches zero, so there's no limit
+        template<typename RR = R>
+        auto size() const -> decltype( static_cast<size_t>( range:: size(std::declval<RR const &>()) ) ) {
+            size_t n = static_cast<size_t>( range:: size(m_r) );
+            return m_how_many >= 0 && static_cast<size_t>(m_how_many) < n ? static_cast<size_t>(m_how_many) : n;
+        }
+        size_t advance_n(size_t n) {
+            if(m_how_many >= 0 && static_cast<size_t>(m_how_many) < n)
+                n = static_cast<size_t>(m_how_many);
+            size_t skipped = range:: advance_n(m_r, n);
+            m_how_many -= static_cast<int64_t>(skipped);
+            return skipped;
+        }
     };
     template<typename R>
     auto operator| (detail:: temporary_tagged_holder<R, decltype(take)> r_holder, int64_t how_many)
@@ -218,16 +424,13 @@ namespace view {
         return take_t<R>{ std:: move(r_holder.m_r), how_many };
     }
 
-    // skip
+    // skip, in one step where the range has random access
     template<typename R>
     auto operator| (detail:: temporary_tagged_holder<R, decltype(skip)> r_holder, int64_t how_many)
     {
-        (void)how_many;
         auto r = std:: move(r_holder.m_r);
-        while(how_many > 0 && !range:: empty(r)) {
-            range:: advance(r);
-            --how_many;
-        }
+        if(how_many > 0)
+            range:: advance_n(r, static_cast<size_t>(how_many));
         return r;
     }
 
@@ -1,10 +1,22 @@
 #include "orange.hh"
+#include "orange_par.hh"
+#include "orange_probe.hh"
+#include "orange_async.hh"
+#include "orange_shard.hh"
+#include "range_view.hh"
+#include "range_from.hh"
 #include "../bits.and.pieces/PP.hh"
 #include "../bits.and.pieces/utils.hh"
 #include "../module-format/format.hh"
 #include<iostream>
+#include<sstream>
+#include<fstream>
+#include<cstdio>
 #include<vector>
 #include<memory>
+#include<atomic>
+#include<cstdlib>
+#include<new>
 using std:: vector;
 using std:: string;
 using namespace orange;
@@ -24,6 +36,77 @@ auto type_as_string(T) {
     return t;
 }
 
+/*
+ * Counting, to check that the adaptors don't copy, or allocate, more than
+ * they should. Every 'operator new' is counted in 'g_allocations', with its
+ * size in 'g_allocated_bytes', and 'counted' counts its own copies and moves.
+ * A test takes a 'usage_since' before the pipeline, and then checks the usage
+ * against limits with 'within', which gives "ok", or the counts if any is
+ * over its limit.
+ */
+static std:: atomic<size_t> g_allocations {0};
+static std:: atomic<size_t> g_allocated_bytes {0};
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"  // our 'delete' matches our 'new', but g++ can't see that
+#endif
+
+void * operator new(size_t n) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(n, std::memory_order_relaxed);
+    if(void * p = std::malloc(n ? n : 1))
+        return p;
+    throw std:: bad_alloc();
+}
+void * operator new[](size_t n)             { return ::operator new(n); }
+void operator delete(void * p) noexcept     { std::free(p); }
+void operator delete[](void * p) noexcept   { std::free(p); }
+void operator delete(void * p, size_t) noexcept     { std::free(p); }
+void operator delete[](void * p, size_t) noexcept   { std::free(p); }
+
+struct counted {
+    static size_t   s_copies;
+    static size_t   s_moves;
+    int             m_v;
+
+    counted(int v) : m_v(v) {}
+    counted(counted const & other)      : m_v(other.m_v) { ++s_copies; }
+    counted(counted && other) noexcept  : m_v(other.m_v) { ++s_moves; }
+    counted & operator= (counted const & other)     { m_v = other.m_v; ++s_copies; return *this; }
+    counted & operator= (counted && other) noexcept { m_v = other.m_v; ++s_moves; return *this; }
+};
+size_t counted:: s_copies   = 0;
+size_t counted:: s_moves    = 0;
+
+struct usage {
+    size_t m_copies;
+    size_t m_moves;
+    size_t m_allocations;
+    size_t m_bytes = size_t(-1);    // no limit, unless it's given
+};
+
+struct usage_since {
+    usage m_start { counted::s_copies, counted::s_moves, g_allocations.load(), g_allocated_bytes.load() };
+
+    usage
+    so_far() const {
+        return { counted::s_copies - m_start.m_copies
+               , counted::s_moves  - m_start.m_moves
+               , g_allocations.load() - m_start.m_allocations
+               , g_allocated_bytes.load() - m_start.m_bytes };
+    }
+};
+
+std::string
+within(usage u, usage limit) {
+    if(u.m_copies <= limit.m_copies && u.m_moves <= limit.m_moves && u.m_allocations <= limit.m_allocations && u.m_bytes <= limit.m_bytes)
+        return "ok";
+    return    "copies="         + std::to_string(u.m_copies)
+            + " moves="         + std::to_string(u.m_moves)
+            + " allocations="   + std::to_string(u.m_allocations)
+            + " bytes="         + std::to_string(u.m_bytes);
+}
+
 #define TEST_ME_AWARE_OF_COMMAS(description, expected)  test_me(__FILE__, __LINE__, description, expected, #expected)
 #define TEST_ME(description, ...)  TEST_ME_AWARE_OF_COMMAS(description, ( __VA_ARGS__ ))
 
@@ -179,5 +262,494 @@ int main () {
                         [](auto x){return x * 1.5;}
                     |collect;
             };
-}
 
+    TEST_ME ( "|collect reserves once, from the size hint"
+            , size_t(1000)
+            ) ^ []()
+            {
+                auto v =
+                zip(ints(1000), ints())
+                    |mapr|  [](auto t){ return std::get<0>(t) + std::get<1>(t); }
+                    |collect
+                    ;
+                return v.capacity();
+            };
+
+    TEST_ME ( "|collect_into reuses the capacity of the vector"
+            , std::make_pair(size_t(3), true)
+            ) ^ []()
+            {
+                std::vector<int> v;
+                ints(1000)              |collect_into(v);
+                auto capacity = v.capacity();
+                auto & same   = ints(3) |collect_into(v);
+                return std::make_pair(same.size(), &same == &v && v.capacity() == capacity);
+            };
+
+    TEST_ME ( "|collect of bools, which can't be pulled in blocks into a vector<bool>"
+            , std::make_pair( std::vector<int>{1,0,1,0,1}, std::vector<int>{1,0,1} )
+            ) ^ []()
+            {
+                std::vector<bool> vb {true,false,true};
+                auto bools   = ints(5) |mapr| [](int x){ return x%2 == 0; } |collect;
+                auto proxies = vb |collect;   // of 'vector<bool>::reference', as 'front' gives them
+                // as 'int's, to be printed
+                return std::make_pair( std::vector<int>(bools.begin(), bools.end())
+                                     , std::vector<int>(proxies.begin(), proxies.end()) );
+            };
+
+    TEST_ME ( "a const vector<bool>, whose iterators aren't contiguous, with |collect, |accumulate and |find_if|"
+            , std::make_tuple( std::vector<int>{0,1,1,0,1}, true, true, false )
+            ) ^ []()
+            {
+                std::vector<bool> const cvb {false,true,true,false,true};
+                auto bools = cvb |collect;
+                return std::make_tuple( std::vector<int>(bools.begin(), bools.end())
+                                      , cvb |accumulate
+                                      , (cvb |find_if| [](bool b){ return b; }).has_value()
+                                      , (cvb |find_if| [](bool)  { return false; }).has_value() );
+            };
+
+    TEST_ME ( "|collect_with an arena"
+            , 41417000 // the sum, over i<500, of i*(i-1)
+            ) ^ []()
+            {
+                orange:: monotonic_arena arena;
+                int total = 0;
+                for(int i = 0; i<500; ++i) {
+                    auto v = ints(i) |mapr| [](int x){ return 2*x; } |collect_with(orange:: arena_allocator<int>(arena));
+                    total += v | accumulate;
+                }
+                return total;
+            };
+
+    TEST_ME ( "|distinct keeps the first of each, and |count_by| counts them"
+            , std::make_pair( std::vector<int>{3,1,2,5}
+                            , std::vector<size_t>{6,1} )
+            ) ^ []()
+            {
+                std::vector<int> v{3,1,3,2,1,5,3};
+                return std::make_pair( v |distinct |collect
+                                     ,     v
+                                        |count_by| [](int x){ return x % 2; }
+                                        |mapr|     [](std::pair<int,size_t> const & kc){ return kc.second; }
+                                        |collect );
+            };
+
+    TEST_ME ( "zip of a |mapr| over a vector, after |skip| and |take|"
+            , std::vector<int>{3*30, 4*40, 5*50}
+            ) ^ []()
+            {
+                std::vector<int> v{0,1,2,3,4,5,6,7};
+                return zip(v |mapr| [](int x){ return 10*x; }, v)
+                        |skip| 3 |take| 3
+                        |mapr| [](auto t){ return std::get<0>(t) * std::get<1>(t); }
+                        |collect;
+            };
+
+    TEST_ME ( "|scan| and an accumulator that catches up with a growing log"
+            , std::make_pair( std::vector<int>{1,3,6,10}, std::vector<int>{10,4,21,6} )
+            ) ^ []()
+            {
+                std::vector<int> log{1,2,3,4};
+                auto running = log |scan| std::plus<>{} |collect;
+
+                auto acc = make_accumulator(0);
+                acc.feed( log |skip| acc.count() );
+                std::vector<int> seen{ acc.total(), int(acc.count()) };
+                log.push_back(5);
+                log.push_back(6);
+                acc.feed( log |skip| acc.count() ); // only the new two
+                seen.push_back( acc.total() );
+                seen.push_back( int(acc.count()) );
+                return std::make_pair(running, seen);
+            };
+
+    TEST_ME ( "|probe| counts the calls, showing that |filter| reads a passing front twice"
+            , std::vector<uint64_t>{10, 15, 5, 5}
+            ) ^ []()
+            {
+                int total = 0;
+                ints(10) |probe| "test.in" |filter| [](int x){ return x % 2 == 1; } |probe| "test.odd"
+                         |foreach| [&](int x){ total += x; };
+                probe_counts in  = probe_registry:: global().counts("test.in");
+                probe_counts odd = probe_registry:: global().counts("test.odd");
+                return std::vector<uint64_t>{ in.m_items, in.m_front, odd.m_items, odd.m_front };
+            };
+
+    TEST_ME ( "|prefetch| reads ahead in another thread, but gives the same items"
+            , ints(1000) |mapr| [](int x){ return int64_t(x)*x; } |accumulate
+            ) ^ []()
+            {
+                return ints(1000) |prefetch| 16 |mapr| [](int x){ return int64_t(x)*x; } |accumulate;
+            };
+
+    TEST_ME ( "a channel hands the items of one thread's pipeline to another's, in order"
+            , ints(10000) |mapr| [](int x){ return int64_t(x)*x; } |collect
+            ) ^ []()
+            {
+                channel<int64_t> ch(100, 16);
+                std:: thread writing( [w = ch.writer()]() mutable {
+                    ints(10000) |foreach| [&](int x){ orange::push(w, int64_t(x)*x); };
+                });
+                auto got = ch.reader() |collect;
+                writing.join();
+                return got;
+            };
+
+    TEST_ME ( "|copy_to| fills a vector, and |write_to| formats into a stream"
+            , std::string("0 1 4 9 | 4\n5\nab\n")
+            ) ^ []()
+            {
+                std::vector<int> squares(4);
+                ints(10) |mapr| [](int x){ return x*x; } |copy_to| squares;
+                std::ostringstream os;
+                {
+                    auto spaced = make_ostream_sink(os, " ");
+                    squares |copy_to| spaced;
+                }
+                os << "| ";
+                ints(4,6)                       |write_to| os;
+                std::vector<std::string>{"ab"}  |write_to| os;
+                return os.str();
+            };
+
+    TEST_ME ( "|collect_static and |foreach, with the size from the type"
+            , std::vector<double>({0.5, 1.5, 2.5, 3.5, 2.5, 3.5})
+            ) ^ []()
+            {
+                auto halves = ints<4>() |mapr| [](int x){ return x + 0.5; } |collect_static;
+                std::vector<double> got(halves.begin(), halves.end());
+                auto rest   = ints<4>() |mapr| [](int x){ return x + 0.5; };
+                orange::advance(rest);
+                orange::advance(rest);
+                std::move(rest) |foreach| [&](double x){ got.push_back(x); };
+                return got;
+            };
+
+    TEST_ME ( "|collect_static throws, rather than read past the end, if some were advanced over"
+            , std::make_pair(true, 10)
+            ) ^ []()
+            {
+                auto rest = as_range(std::array<int,4>{{1, 2, 3, 4}}) |mapr| [](int x){ return 10*x; };
+                orange::advance(rest);
+                bool threw = false;
+                try                             { std::move(rest) |collect_static; }
+                catch(std::length_error const &){ threw = true; }
+                auto whole = as_range(std::array<int,4>{{1, 2, 3, 4}}) |mapr| [](int x){ return 10*x; } |collect_static;
+                return std::make_pair(threw, whole[0]);
+            };
+
+    TEST_ME ( "|unzip_collect splits the rows that pass a |filter| into columns"
+            , std::string("b d | 2 4 ")
+            ) ^ []()
+            {
+                std::vector<std::string>    names   {"a", "b", "c", "d"};
+                std::vector<int>            numbers {1, 2, 3, 4};
+                auto cols = zip(names, numbers) |filter| [](auto row){ return std::get<1>(row) % 2 == 0; } |unzip_collect;
+                std::ostringstream os;
+                {
+                    auto spaced = make_ostream_sink(os, " ");
+                    std::get<0>(cols) |copy_to| spaced;
+                    orange::push(spaced, "|");
+                    std::get<1>(cols) |copy_to| spaced;
+                }
+                return os.str();
+            };
+
+    TEST_ME ( "|par_accumulate matches |accumulate"
+            , ints(100000) |mapr| [](int x){ return int64_t(x)*x; } |filter| [](int64_t x){ return x%3 == 1; } |accumulate
+            ) ^ []()
+            {
+                std::vector<int> v;
+                ints(100000) |foreach| [&](int x){ v.push_back(x); };
+                return v |mapr| [](int x){ return int64_t(x)*x; } |filter| [](int64_t x){ return x%3 == 1; } |par_accumulate;
+            };
+
+    TEST_ME ( "|find_if| and |par_find_if| give the first match, and |min_max the extremes"
+            , std::make_tuple(70001.0, 70001.0, true, false, -1.0, 99999.0)
+            ) ^ []()
+            {
+                std::vector<double> v;
+                ints(100000) |foreach| [&](int x){ v.push_back(x % 10000 == 7001 ? -1 : x); };
+                orange:: thread_pool pool(3);
+                auto big    = [](double x){ return x > 70000; };
+                return std::make_tuple( *(v |find_if| big)
+                                      , *(v |par_find_if.grain(1000).on(pool)| big)
+                                      , v |par_any_of.grain(1000).on(pool)| [](double x){ return x < 0; }
+                                      , v |par_all_of.grain(1000).on(pool)| [](double x){ return x >= 0; }
+                                      , (*(v |min_max)).m_min
+                                      , (*(v |min_max)).m_max
+                                      );
+            };
+
+    TEST_ME ( "shards, sent as text, and merged, give the same answer as the whole range"
+            , std::make_tuple( ints(1000001) |mapr| [](int x){ return int64_t(x)*x; } |filter| [](int64_t x){ return x%3 == 1; } |accumulate
+                             , std::string("orange-shard 1 ints 1000001 333334 666668 1 3")
+                             , 5 - 1000000, 5
+                             , true
+                             , int64_t(1000000)*1000001/2, size_t(1000001) )
+            ) ^ []()
+            {
+                auto source     = ints(1000001);
+                auto pipeline   = [](auto r){ return std::move(r) |mapr| [](int x){ return int64_t(x)*x; } |filter| [](int64_t x){ return x%3 == 1; } |accumulate; };
+                auto extremes   = run_all_shards("ints", source, 7, [](auto r){ return std::move(r) |mapr| [](int x){ return 5 - x; } |min_max; });
+                bool wrong_name_throws = false;
+                try { run_shard("other", source, make_shards("ints", source, 3)[0], pipeline); }
+                catch(std::invalid_argument const &) { wrong_name_throws = true; }
+                return std::make_tuple( run_all_shards("ints", source, 7, pipeline)
+                                      , to_string(make_shards("ints", source, 3)[1])
+                                      , (*extremes).m_min, (*extremes).m_max
+                                      , wrong_name_throws
+                                      , run_all_shards("ints", source, 4, [](auto r){ return make_accumulator(int64_t(0)).feed(std::move(r)); }).total()
+                                      , run_all_shards("ints", source, 4, [](auto r){ return make_accumulator(int64_t(0)).feed(std::move(r)); }).count() );
+            };
+
+    TEST_ME ( "shards of range::from::mmap_records give the same answer as the whole file"
+            , std::make_tuple( ints(10000) |mapr| [](int x){ return int64_t(x)*x; } |accumulate
+                             , std::string("orange-shard 1 recs 10000 1429 2858 1 7") )
+            ) ^ []()
+            {
+                {
+                    std::ofstream out("test.orange.shard.recs", std::ios::binary);
+                    for(int i = 0; i<10000; ++i)
+                        out.write(reinterpret_cast<char const*>(&i), sizeof i);
+                }
+                auto recs       = range::from::mmap_records<int>("test.orange.shard.recs");
+                auto pipeline   = [](auto r){ return std::move(r) |mapr| [](int x){ return int64_t(x)*x; } |accumulate; };
+                auto result     = std::make_tuple( run_all_shards("recs", recs, 7, pipeline)
+                                                 , to_string(make_shards("recs", recs, 7)[1]) );
+                std::remove("test.orange.shard.recs");
+                return result;
+            };
+
+    TEST_ME ( "|par_accumulate on a pool with a small grain"
+            , int64_t(99999)*100000/2
+            ) ^ []()
+            {
+                orange:: thread_pool pool(3);
+                return ints(100000) |mapr| [](int x){ return int64_t(x); } |par_accumulate.grain(100).on(pool);
+            };
+
+    TEST_ME ( "|par_accumulate over |filter| |take| matches |accumulate, as |take| is only sliced where it has a size"
+            , std::make_tuple( 9, 9, 100, 100 )
+            ) ^ []()
+            {
+                orange:: thread_pool pool(3);
+                std::vector<int> v {1,2,4,6,3,5,7,9,11};
+                auto odd = [](int x){ return x % 2 == 1; };
+                auto alternating = ints(1000) |mapr| [](int x){ return x % 2; } |collect;
+                auto one = [](int x){ return x == 1; };
+                return std::make_tuple( v |filter| odd |take| 3 |accumulate
+                                      , v |filter| odd |take| 3 |par_accumulate.grain(1).on(pool)
+                                      , alternating |filter| one |take| 100 |accumulate
+                                      , alternating |filter| one |take| 100 |par_accumulate.grain(10).on(pool) );
+            };
+
+    // copies, moves and allocations, for 1000 items
+    constexpr size_t n = 1000;
+    auto make_counted   = [](int x){ return counted{x}; };
+    auto value_of       = [](counted const & c){ return c.m_v; };
+
+    TEST_ME ( "no copies: |mapr| |accumulate over a vector of lvalues"
+            , std::string("ok")
+            ) ^ [&]()
+            {
+                std::vector<counted> v(ints(n) |mapr| make_counted |collect);
+                usage_since start;
+                auto total = v |mapr| value_of |accumulate;
+                (void)total;
+                return within(start.so_far(), {0, 0, 0});
+            };
+
+    TEST_ME ( "one copy of each that passes a |filter|, into a |collect"
+            , std::string("ok")
+            ) ^ [&]()
+            {
+                std::vector<counted> v(ints(n) |mapr| make_counted |collect);
+                usage_since start;
+                auto odd = v |filter| [](counted const & c){ return c.m_v % 2 != 0; } |collect;
+                // the hint is only a bound, so the vector grows, moving what it has
+                return within(start.so_far(), {n/2, n/2 + n, 12});
+            };
+
+    TEST_ME ( "one allocation, and no copies, for |mapr| into |collect"
+            , std::string("ok")
+            ) ^ [&]()
+            {
+                usage_since start;
+                auto v = ints(n) |mapr| make_counted |collect;
+                return within(start.so_far(), {0, n, 1});
+            };
+
+    TEST_ME ( "|memoize moves the items out, rather than copying"
+            , std::string("ok")
+            ) ^ [&]()
+            {
+                std::vector<counted> out;
+                out.reserve(2*n);
+                usage_since start;
+                ints(n) |mapr| make_counted |memoize      |collect_into(out);
+                ints(n) |mapr| make_counted |memoize_n<4> |collect_into(out);
+                // into the store, out of it, and into the vector
+                return within(start.so_far(), {0, 2 * 3*n, 0});
+            };
+
+    TEST_ME ( "no allocations for |collect_static, |find_if| or |unzip<I>"
+            , std::string("ok")
+            ) ^ [&]()
+            {
+                std::vector<counted> v(ints(n) |mapr| make_counted |collect);
+                usage_since start;
+                auto a      = ints<64>() |mapr| make_counted |collect_static;
+                auto found  = v |find_if| [](counted const & c){ return c.m_v == 500; };
+                auto total  = zip_as_is(v, ints()) |unzip<0> |mapr| value_of |accumulate;
+                (void)a; (void)found; (void)total;
+                // the one that's found is copied
+                return within(start.so_far(), {1, 0, 0});
+            };
+
+    TEST_ME ( "|count_by| and |distinct allocate for the keys, not for the items"
+            , std::make_tuple( std::string("ok"), std::string("ok"), size_t(2), size_t(3) )
+            ) ^ []()
+            {
+                constexpr int many = 1000000;
+                usage_since counting;
+                auto counts = ints(many) |count_by| [](int x){ return x % 2; };
+                usage counting_usage = counting.so_far();
+                usage_since finding;
+                auto keys = ints(many) |mapr| [](int x){ return x % 3; } |distinct |collect;
+                usage finding_usage = finding.so_far();
+                // a few small vectors, however many items there are
+                return std::make_tuple( within(counting_usage, {0, 0, 8, 1024})
+                                      , within(finding_usage,  {0, 0, 8, 1024})
+                                      , counts.size(), keys.size() );
+            };
+
+    TEST_ME ( "view::which and view::which_collect over bytes, bits with an offset, and vector<bool>"
+            , std::make_tuple( vector<uint64_t>{1,2,4,9,10}, vector<uint64_t>{1,2,4,9,10}
+                             , vector<uint64_t>{1,2,4,9,10}
+                             , vector<uint64_t>{0,2,61,120}, vector<uint64_t>{0,2,61,120}
+                             , vector<uint64_t>{1,2,4}, vector<uint64_t>{1,2,4}, vector<uint64_t>{1,2,4}
+                             , vector<uint64_t>{}, vector<uint64_t>{} )
+            ) ^ []()
+            {
+                auto indices = [](auto w) {
+                    vector<uint64_t> out;
+                    for(; !range::empty(w); range::advance(w))
+                        out.push_back(range::front_val(w));
+                    return out;
+                };
+                // more than one block of bytes, and the last not full
+                vector<uint8_t>     bytes       {0,1,7,0,255,0,0,0, 0,1,1};
+                // bits 5, 70, 72, 131 and 190 of 191, and 191 which is past the end
+                uint64_t const      words[]     {uint64_t(1)<<5, (uint64_t(1)<<6) | (uint64_t(1)<<8), (uint64_t(1)<<3) | (uint64_t(3)<<62)};
+                auto                from_70     = [&]() { auto b = range::from_bit_words(words, 191); b.advance_n(70); return b; };
+                vector<bool>        bools       {false,true,true,false,true};
+                vector<bool> const  cbools      {false,true,true,false,true};
+                vector<uint8_t>     none;
+                return std::make_tuple( indices(range::from_vector(bytes) |range::view::which)
+                                      , range::from_vector(bytes) |range::view::which_collect
+                                      , indices(range::range_from_begin_end(bytes.data(), bytes.data() + bytes.size()) |range::view::which)
+                                      , indices(from_70() |range::view::which)
+                                      , from_70() |range::view::which_collect
+                                      , indices(range::from_vector(bools) |range::view::which)
+                                      , range::from_vector(bools) |range::view::which_collect
+                                      , indices(range::range_from_begin_end(cbools.begin(), cbools.end()) |range::view::which)
+                                      , indices(range::from_vector(none) |range::view::which)
+                                      , range::from_vector(none) |range::view::which_collect );
+            };
+
+    TEST_ME ( "range::from::lines and owning_lines, with no input, no final newline, and lines longer than the buffer"
+            , std::make_tuple( vector<string>{}, vector<string>{"ab", "", "a much longer line", "end"}, vector<string>{"one", "two"}
+                             , vector<string>{}, vector<string>{"ab", "", "a much longer line", "end"}, vector<string>{"one", "two"} )
+            ) ^ []()
+            {
+                auto read_all = [](std::string text, auto make_lines) {
+                    std::istringstream in(text);
+                    vector<string> out;
+                    for(auto l = make_lines(in); !orange::empty(l); orange::advance(l)) {
+                        auto line = orange::front(l);
+                        out.push_back(std::string(line.data(), line.size()));
+                    }
+                    return out;
+                };
+                auto viewing    = [](std::istream & in) { return range::from::lines(in, 4); };
+                auto owning     = [](std::istream & in) { return range::from::owning_lines(in, 4); };
+                return std::make_tuple( read_all("", viewing), read_all("ab\n\na much longer line\nend", viewing), read_all("one\ntwo\n", viewing)
+                                      , read_all("", owning),  read_all("ab\n\na much longer line\nend", owning),  read_all("one\ntwo\n", owning) );
+            };
+
+    TEST_ME ( "range::from::mmap_records, with |collect, slice and pull_n, and the files it refuses"
+            , std::make_tuple( vector<int>{1,2,3,4,5}, vector<int>{2,3,4}, size_t(3), vector<int>{1,2,3}, size_t(2)
+                             , size_t(0), true
+                             , true, true
+                             , vector<ptrdiff_t>{0,1,2,3,4}, vector<int>{2,4} )
+            ) ^ []()
+            {
+                auto write_file = [](std::string const & path, std::string const & bytes) {
+                    std::ofstream(path, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+                };
+                int const five[] {1,2,3,4,5};
+                write_file("test.orange.mmap.five",  std::string(reinterpret_cast<char const*>(five), sizeof five));
+                write_file("test.orange.mmap.empty", "");
+                write_file("test.orange.mmap.odd",   "123456");
+
+                auto records    = range::from::mmap_records<int>("test.orange.mmap.five");
+                auto middle     = orange::slice(records, 1, 4);
+                auto rest       = records;
+                int  first[3];
+                size_t got      = orange::pull_n(rest, first, 3);
+
+                auto none       = range::from::mmap_records<int>("test.orange.mmap.empty");
+
+                auto throws = [](char const * path) {
+                    try                                 { range::from::mmap_records<int>(path); }
+                    catch(std::runtime_error const &)   { return true; }
+                    return false;
+                };
+                auto result = std::make_tuple( records |collect, middle |collect, got, vector<int>(first, first+3), orange::size(rest)
+                                             , orange::size(none), orange::empty(none)
+                                             , throws("test.orange.mmap.odd"), throws("test.orange.mmap.missing")
+                                             // functions that take a reference see the records themselves, not copies
+                                             , records |mapr| [&](int const & x){ return &x - records.data(); } |collect
+                                             , records |filter| [&](int const & x){ return (&x - records.data()) % 2 == 1; } |collect );
+                std::remove("test.orange.mmap.five");
+                std::remove("test.orange.mmap.empty");
+                std::remove("test.orange.mmap.odd");
+                return result;
+            };
+
+    TEST_ME ( "|chunk| and |group_by| over ranges that can't be sliced into batches, so are buffered"
+            , std::make_tuple( vector<vector<int>>{{1,3},{5,7},{9}}
+                             , vector<vector<int>>{{1,2,4},{5,7,8},{10,11,13,14},{16,17,19}}
+                             , vector<vector<int>>{}, vector<vector<int>>{}
+                             , vector<vector<string>>{{"a","b"},{"c"}}
+                             , vector<vector<string>>{{"ab","ac"},{"b"},{"cd","ce"}}
+                             , vector<vector<int>>{{1,1},{1,1},{1}}
+                             , vector<vector<int>>{{1,1},{0},{1},{0,0}} )
+            ) ^ []()
+            {
+                auto each_collected = [](auto batches) {
+                    return std::move(batches) |mapr| [](auto b){ return std::move(b) |collect; } |collect;
+                };
+                auto as_ints = [](auto batches) {
+                    return std::move(batches) |mapr| [](auto b){ return std::move(b) |mapr| [](bool x){ return int(x); } |collect; } |collect;
+                };
+                auto odd        = [](int x){ return x % 2 == 1; };
+                auto not_3s     = [](int x){ return x % 3 != 0; };
+                auto none       = [](int x){ return x > 100; };
+                static_assert(!can_slice_into_batches< decltype( ints(10) |filter| odd ) > ,"");
+                std::istringstream  three_lines("a\nb\nc");
+                std::istringstream  five_lines("ab\nac\nb\ncd\nce\n");
+                return std::make_tuple( each_collected( ints(10) |filter| odd |chunk| 2 )
+                                      , each_collected( ints(20) |filter| not_3s |group_by| [](int x){ return x / 5; } )
+                                      , each_collected( ints(10) |filter| none |chunk| 3 )
+                                      , each_collected( ints(10) |filter| none |group_by| [](int x){ return x / 5; } )
+                                      , each_collected( range::from::owning_lines(three_lines) |chunk| 2 )
+                                      , each_collected( range::from::owning_lines(five_lines) |group_by| [](string const & l){ return l[0]; } )
+                                      // of 'bool's, which are buffered in an array rather than a 'vector<bool>'. As 'int's, to be printed
+                                      , as_ints( ints(15) |mapr| [](int x){ return x%3 == 0; } |filter| [](bool b){ return b; } |chunk| 2 )
+                                      , as_ints( ints(9)  |mapr| [](int x){ return x%3 == 0 || x == 1; } |filter| [](bool){ return true; } |take| 6 |group_by| [](bool b){ return b; } ) );
+            };
+}